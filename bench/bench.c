@@ -0,0 +1,81 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#define WARMUP_NS 20e6
+#define REPETITION_NS 1e6
+#define REPETITIONS 101
+
+double bench_nowNs() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1e9 + (double) time.tv_nsec;
+}
+
+static int compareDoubles(const void *const a, const void *const b) {
+    const double l = *(const double *) a;
+    const double r = *(const double *) b;
+    return (l > r) - (l < r);
+}
+
+BenchResult bench_run(const Benchmark *const benchmark) {
+    // Doubling the call count until a run takes long enough both warms caches and calibrates the repetitions
+    size_t calls = 1;
+    double elapsed = 0.0;
+    const double warmupStart = bench_nowNs();
+    while (elapsed < REPETITION_NS || bench_nowNs() - warmupStart < WARMUP_NS) {
+        const double start = bench_nowNs();
+        benchmark->function(benchmark->state, calls);
+        elapsed = bench_nowNs() - start;
+        if (elapsed < REPETITION_NS) calls *= 2;
+    }
+
+    double nsPerItem[REPETITIONS];
+    const double items = (double) calls * (double) benchmark->batch;
+    for (int i = 0; i < REPETITIONS; i++) {
+        const double start = bench_nowNs();
+        benchmark->function(benchmark->state, calls);
+        nsPerItem[i] = (bench_nowNs() - start) / items;
+    }
+    qsort(nsPerItem, REPETITIONS, sizeof(double), compareDoubles);
+
+    const double median = nsPerItem[REPETITIONS / 2];
+    return (BenchResult) {
+        median,
+        nsPerItem[REPETITIONS * 99 / 100],
+        1e9 / median,
+        REPETITIONS,
+    };
+}
+
+void bench_printHeader() {
+    fprintf(stderr, "%-32s %-8s %8s %14s %14s %16s\n", "benchmark", "variant", "batch", "median ns/op", "p99 ns/op",
+           "items/s");
+}
+
+void bench_print(const Benchmark *const benchmark, const BenchResult *const result) {
+    fprintf(stderr, "%-32s %-8s %8zu %14.3f %14.3f %16.0f\n", benchmark->name, benchmark->variant, benchmark->batch,
+           result->nsPerItemMedian, result->nsPerItemP99, result->itemsPerSecond);
+}
+
+void bench_writeJson(FILE *const file, const Benchmark benchmarks[], const BenchResult results[],
+                     const size_t count) {
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < count; i++) {
+        fprintf(
+            file,
+            "    {\"name\": \"%s\", \"variant\": \"%s\", \"batch\": %zu, \"repetitions\": %zu, "
+            "\"ns_per_op_median\": %.4f, \"ns_per_op_p99\": %.4f, \"items_per_second\": %.1f}%s\n",
+            benchmarks[i].name,
+            benchmarks[i].variant,
+            benchmarks[i].batch,
+            results[i].repetitions,
+            results[i].nsPerItemMedian,
+            results[i].nsPerItemP99,
+            results[i].itemsPerSecond,
+            i + 1 < count ? "," : ""
+        );
+    }
+    fprintf(file, "  ]\n}\n");
+}
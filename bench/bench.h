@@ -0,0 +1,41 @@
+#ifndef BENCH_H
+#define BENCH_H
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+ * Runs count operations on the state given to bench_run. A batch benchmark performs count * batch item
+ * operations; the harness accounts for that through Benchmark.batch.
+ */
+typedef void (*BenchFunction)(void *state, size_t count);
+
+typedef struct {
+    const char *name;
+    const char *variant;
+    size_t batch;
+    BenchFunction function;
+    void *state;
+} Benchmark;
+
+typedef struct {
+    double nsPerItemMedian;
+    double nsPerItemP99;
+    double itemsPerSecond;
+    size_t repetitions;
+} BenchResult;
+
+double bench_nowNs();
+
+/**
+ * Warms the benchmark up, calibrates the number of calls so a repetition takes about a millisecond and
+ * collects per-item timings over a fixed number of repetitions.
+ */
+BenchResult bench_run(const Benchmark *benchmark);
+
+void bench_printHeader();
+
+void bench_print(const Benchmark *benchmark, const BenchResult *result);
+
+void bench_writeJson(FILE *file, const Benchmark benchmarks[], const BenchResult results[], size_t count);
+
+#endif //BENCH_H
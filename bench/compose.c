@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "math/matrix.h"
+#include "math/rad.h"
+
+/*
+ * Composes translation * rotation and vp * model for every object of a frame, the way render() builds its MVP,
+ * and reports the time per frame. Built twice by CMake: with the out-of-line math and with DUMMY3D_INLINE_MATH.
+ */
+
+#define FRAMES 200
+
+static double nowNs() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1e9 + (double) time.tv_nsec;
+}
+
+static void composeFrame(const Matrix4f *const vp, const Vector3f *const positions, const Matrix4f *const rotations,
+                         Matrix4f *const mvps, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Matrix4f translation, model;
+        mat_translation(&translation, positions + i);
+        mat_multMat4f(&translation, rotations + i, &model);
+        mat_multMat4f(vp, &model, mvps + i);
+    }
+}
+
+int main() {
+    static const size_t objectCounts[] = {100, 1000, 10000};
+
+#if defined(DUMMY3D_INLINE_MATH) && defined(__AVX__)
+    printf("mode: inline (AVX)\n");
+#elif defined(DUMMY3D_INLINE_MATH)
+    printf("mode: inline (SSE2)\n");
+#else
+    printf("mode: out-of-line (%s)\n", mat_getBackendName(mat_getBackend()));
+#endif
+
+    Matrix4f vp, view, perspective;
+    const Vector3f eye = {-3.0f, 3.0f, -3.0f};
+    mat_translation(&view, &eye);
+    mat_perspective(&perspective, 0.7f, toRad(75.0f), 0.1f, 100.0f);
+    mat_multMat4f(&perspective, &view, &vp);
+
+    for (size_t c = 0; c < sizeof(objectCounts) / sizeof(objectCounts[0]); c++) {
+        const size_t count = objectCounts[c];
+        Vector3f *positions = malloc(count * sizeof(Vector3f));
+        Matrix4f *rotations = aligned_alloc(_Alignof(Matrix4f), count * sizeof(Matrix4f));
+        Matrix4f *mvps = aligned_alloc(_Alignof(Matrix4f), count * sizeof(Matrix4f));
+        for (size_t i = 0; i < count; i++) {
+            positions[i] = (Vector3f) {(float) (i % 100), (float) (i / 100 % 100), (float) (i / 10000)};
+            const Vector3f rotation = {toRad((float) (i % 360)), toRad((float) (i % 90)), 0.0f};
+            mat_rotation(rotations + i, &rotation);
+        }
+
+        composeFrame(&vp, positions, rotations, mvps, count);
+        const double start = nowNs();
+        for (int frame = 0; frame < FRAMES; frame++) {
+            composeFrame(&vp, positions, rotations, mvps, count);
+        }
+        const double frameNs = (nowNs() - start) / FRAMES;
+
+        float checksum = 0.0f;
+        for (size_t i = 0; i < count; i++) checksum += mvps[i].t[3][2];
+        printf("%6zu objects: %10.0f ns/frame %6.2f ns/object (checksum %g)\n", count, frameNs,
+               frameNs / (double) count, checksum);
+
+        free(positions);
+        free(rotations);
+        free(mvps);
+    }
+    return 0;
+}
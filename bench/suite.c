@@ -0,0 +1,323 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "camera.h"
+#include "math/matrix.h"
+#include "math/rad.h"
+#include "transform.h"
+
+/*
+ * Hot-path microbenchmarks for the math library, the camera, scene transforms and frustum culling.
+ * No window or GL context is involved.
+ * Usage: dummy3d_bench [--json FILE] [--filter SUBSTRING]
+ * A readable table goes to stderr while running; the JSON report goes to FILE, or to stdout without --json.
+ * Matrix benchmarks run once per supported backend; the batch is the number of items processed per call.
+ */
+
+#define MAX_BATCH 4096
+#define CULL_BATCH 65536
+#define TRANSFORM_ROOTS 64
+#define TRANSFORM_CHILDREN 8
+#define TRANSFORM_GRANDCHILDREN 7
+#define MAX_BENCHMARKS 128
+
+typedef struct {
+    size_t batch;
+    Matrix4f *a;
+    Matrix4f *b;
+    Matrix4f *res;
+    Vector4f *vectors;
+    Vector4f *vectorsRes;
+    Vector3f *angles;
+    float *aspects;
+} MathState;
+
+typedef struct {
+    Camera *camera;
+    float step;
+} CameraState;
+
+typedef struct {
+    size_t batch;
+    const Frustum *frustum;
+    float *x;
+    float *y;
+    float *z;
+    float *size;
+    uint32_t *visible;
+    size_t visibleCount;
+} CullState;
+
+static void multMat4f(void *const state, const size_t count) {
+    const MathState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        for (size_t i = 0; i < s->batch; i++) mat_multMat4f(s->a + i, s->b + i, s->res + i);
+    }
+}
+
+static void multVec4f(void *const state, const size_t count) {
+    const MathState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        for (size_t i = 0; i < s->batch; i++) mat_multVec4f(s->a + i, s->vectors + i, s->vectorsRes + i);
+    }
+}
+
+static void rotation(void *const state, const size_t count) {
+    const MathState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        for (size_t i = 0; i < s->batch; i++) mat_rotation(s->res + i, s->angles + i);
+    }
+}
+
+static void perspective(void *const state, const size_t count) {
+    const MathState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        for (size_t i = 0; i < s->batch; i++) mat_perspective(s->res + i, s->aspects[i], toRad(75.0f), 0.1f, 100.0f);
+    }
+}
+
+static void cameraDirty(void *const state, const size_t count) {
+    CameraState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        // Moving and rotating invalidates the view; a new aspect ratio invalidates the projection
+        cam_move(s->camera, s->step, 0.0f, 0.0f);
+        cam_rotate(s->camera, 0.0f, s->step, 0.0f);
+        cam_setAspect(s->camera, 1.0f + s->step);
+        cam_updateMatrices(s->camera);
+        s->step = -s->step;
+    }
+}
+
+static void cameraClean(void *const state, const size_t count) {
+    const CameraState *const s = state;
+    for (size_t c = 0; c < count; c++) cam_updateMatrices(s->camera);
+}
+
+typedef struct {
+    TransformTree *tree;
+    float step;
+} TransformState;
+
+static void transformStatic(void *const state, const size_t count) {
+    const TransformState *const s = state;
+    for (size_t c = 0; c < count; c++) tr_update(s->tree);
+}
+
+static void transformMoving(void *const state, const size_t count) {
+    TransformState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        // Moving every root makes the whole hierarchy dirty
+        for (TransformId root = 0; root < TRANSFORM_ROOTS; root++) {
+            const Vector3f position = {(float) root, s->step, 0.0f};
+            tr_setPosition(s->tree, root, &position);
+        }
+        tr_update(s->tree);
+        s->step = -s->step;
+    }
+}
+
+static void cullSpheres(void *const state, const size_t count) {
+    CullState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        s->visibleCount = cull_spheres(s->frustum, s->x, s->y, s->z, s->size, s->batch, s->visible);
+    }
+}
+
+static void cullAabbs(void *const state, const size_t count) {
+    CullState *const s = state;
+    for (size_t c = 0; c < count; c++) {
+        s->visibleCount = cull_aabbs(s->frustum, s->x, s->y, s->z, s->size, s->size, s->size, s->batch, s->visible);
+    }
+}
+
+static MathState allocateMathState() {
+    MathState s = {
+        0,
+        aligned_alloc(_Alignof(Matrix4f), MAX_BATCH * sizeof(Matrix4f)),
+        aligned_alloc(_Alignof(Matrix4f), MAX_BATCH * sizeof(Matrix4f)),
+        aligned_alloc(_Alignof(Matrix4f), MAX_BATCH * sizeof(Matrix4f)),
+        malloc(MAX_BATCH * sizeof(Vector4f)),
+        malloc(MAX_BATCH * sizeof(Vector4f)),
+        malloc(MAX_BATCH * sizeof(Vector3f)),
+        malloc(MAX_BATCH * sizeof(float)),
+    };
+    if (s.a == NULL || s.b == NULL || s.res == NULL || s.vectors == NULL || s.vectorsRes == NULL ||
+        s.angles == NULL || s.aspects == NULL) {
+        fprintf(stderr, "Failed to allocate the benchmark data\n");
+        abort();
+    }
+    for (size_t i = 0; i < MAX_BATCH; i++) {
+        const float f = (float) i;
+        s.angles[i] = (Vector3f) {toRad(f * 0.37f), toRad(f * 0.11f), toRad(f * 0.73f)};
+        s.aspects[i] = 0.5f + f / MAX_BATCH;
+        s.vectors[i] = (Vector4f) {f, -f, 0.5f * f, 1.0f};
+        const Vector3f offset = {f, 1.0f, -f};
+        mat_rotation(s.a + i, s.angles + i);
+        mat_translation(s.b + i, &offset);
+    }
+    return s;
+}
+
+static void freeMathState(const MathState *const s) {
+    free(s->a);
+    free(s->b);
+    free(s->res);
+    free(s->vectors);
+    free(s->vectorsRes);
+    free(s->angles);
+    free(s->aspects);
+}
+
+int main(const int argc, char **const argv) {
+    const char *jsonPath = NULL;
+    const char *filter = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--json FILE] [--filter SUBSTRING]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const size_t batches[] = {1, 64, MAX_BATCH};
+    static const struct {
+        const char *name;
+        BenchFunction function;
+    } mathBenchmarks[] = {
+        {"mat_multMat4f", multMat4f},
+        {"mat_multVec4f", multVec4f},
+        {"mat_rotation", rotation},
+        {"mat_perspective", perspective},
+    };
+    const size_t batchCount = sizeof(batches) / sizeof(batches[0]);
+    const size_t mathCount = sizeof(mathBenchmarks) / sizeof(mathBenchmarks[0]);
+
+    MathState mathStates[sizeof(batches) / sizeof(batches[0])];
+    for (size_t b = 0; b < batchCount; b++) {
+        mathStates[b] = allocateMathState();
+        mathStates[b].batch = batches[b];
+    }
+
+    Camera *camera = cam_allocate();
+    cam_setPrefs(camera, toRad(75.0f), 0.1f, 100.0f);
+    cam_setAspect(camera, 16.0f / 9.0f);
+    cam_updateMatrices(camera);
+    CameraState cameraState = {camera, 0.01f};
+
+    TransformTree *tree = tr_allocate(TRANSFORM_ROOTS * (1 + TRANSFORM_CHILDREN * (1 + TRANSFORM_GRANDCHILDREN)));
+    for (int root = 0; root < TRANSFORM_ROOTS; root++) tr_add(tree, TR_NO_PARENT);
+    for (TransformId root = 0; root < TRANSFORM_ROOTS; root++) {
+        for (int child = 0; child < TRANSFORM_CHILDREN; child++) {
+            const TransformId id = tr_add(tree, root);
+            const Vector3f offset = {1.0f, (float) child, 0.0f};
+            tr_setPosition(tree, id, &offset);
+            for (int grandchild = 0; grandchild < TRANSFORM_GRANDCHILDREN; grandchild++) {
+                const Vector3f rotation = {0.0f, toRad((float) grandchild * 10.0f), 0.0f};
+                Quatf orientation;
+                quat_fromEuler(&orientation, &rotation);
+                tr_setOrientation(tree, tr_add(tree, id), &orientation);
+            }
+        }
+    }
+    tr_update(tree);
+    TransformState transformState = {tree, 0.01f};
+
+    // Objects scattered around the camera, most of them out of view like in a large scene
+    static const size_t cullBatches[] = {64, MAX_BATCH, CULL_BATCH};
+    float *cullData = malloc(4 * CULL_BATCH * sizeof(float));
+    uint32_t *visible = malloc(CULL_BATCH * sizeof(uint32_t));
+    if (cullData == NULL || visible == NULL) {
+        fprintf(stderr, "Failed to allocate the benchmark data\n");
+        abort();
+    }
+    srand(1);
+    for (size_t i = 0; i < 4 * CULL_BATCH; i++) cullData[i] = (float) rand() / (float) RAND_MAX * 200.0f - 100.0f;
+    for (size_t i = 3 * CULL_BATCH; i < 4 * CULL_BATCH; i++) cullData[i] = cullData[i] * 0.01f + 1.0f;
+    CullState cullStates[sizeof(cullBatches) / sizeof(cullBatches[0])];
+    for (size_t b = 0; b < sizeof(cullBatches) / sizeof(cullBatches[0]); b++) {
+        cullStates[b] = (CullState) {
+            cullBatches[b], camera->frustum, cullData, cullData + CULL_BATCH, cullData + 2 * CULL_BATCH,
+            cullData + 3 * CULL_BATCH, visible, 0,
+        };
+    }
+
+    Benchmark benchmarks[MAX_BENCHMARKS];
+    BenchResult results[MAX_BENCHMARKS];
+    size_t count = 0;
+
+    bench_printHeader();
+    const MatBackend defaultBackend = mat_getBackend();
+    for (MatBackend backend = 0; backend < MAT_BACKEND_COUNT; backend++) {
+        if (!mat_setBackend(backend)) continue;
+        for (size_t m = 0; m < mathCount; m++) {
+            if (filter != NULL && strstr(mathBenchmarks[m].name, filter) == NULL) continue;
+            for (size_t b = 0; b < batchCount; b++) {
+                benchmarks[count] = (Benchmark) {
+                    mathBenchmarks[m].name, mat_getBackendName(backend), batches[b], mathBenchmarks[m].function,
+                    mathStates + b,
+                };
+                results[count] = bench_run(benchmarks + count);
+                bench_print(benchmarks + count, results + count);
+                count++;
+            }
+        }
+    }
+    mat_setBackend(defaultBackend);
+
+    const char *const defaultName = mat_getBackendName(defaultBackend);
+    const Benchmark cameraBenchmarks[] = {
+        {"cam_updateMatrices/dirty", defaultName, 1, cameraDirty, &cameraState},
+        {"cam_updateMatrices/clean", defaultName, 1, cameraClean, &cameraState},
+        {"tr_update/static", defaultName, tree->count, transformStatic, &transformState},
+        {"tr_update/moving", defaultName, tree->count, transformMoving, &transformState},
+    };
+    for (size_t c = 0; c < sizeof(cameraBenchmarks) / sizeof(cameraBenchmarks[0]); c++) {
+        if (filter != NULL && strstr(cameraBenchmarks[c].name, filter) == NULL) continue;
+        benchmarks[count] = cameraBenchmarks[c];
+        results[count] = bench_run(benchmarks + count);
+        bench_print(benchmarks + count, results + count);
+        count++;
+    }
+#ifdef __SSE2__
+    const char *cullVariant = "sse2";
+#else
+    const char *cullVariant = "scalar";
+#endif
+    for (size_t b = 0; b < sizeof(cullBatches) / sizeof(cullBatches[0]); b++) {
+        const Benchmark cullBenchmarks[] = {
+            {"cull_spheres", cullVariant, cullBatches[b], cullSpheres, cullStates + b},
+            {"cull_aabbs", cullVariant, cullBatches[b], cullAabbs, cullStates + b},
+        };
+        for (size_t c = 0; c < sizeof(cullBenchmarks) / sizeof(cullBenchmarks[0]); c++) {
+            if (filter != NULL && strstr(cullBenchmarks[c].name, filter) == NULL) continue;
+            benchmarks[count] = cullBenchmarks[c];
+            results[count] = bench_run(benchmarks + count);
+            bench_print(benchmarks + count, results + count);
+            count++;
+        }
+    }
+
+    if (jsonPath != NULL) {
+        FILE *file = fopen(jsonPath, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Failed to open %s\n", jsonPath);
+            return 1;
+        }
+        bench_writeJson(file, benchmarks, results, count);
+        fclose(file);
+    } else {
+        bench_writeJson(stdout, benchmarks, results, count);
+    }
+
+    cam_dispose(camera);
+    tr_dispose(tree);
+    free(cullData);
+    free(visible);
+    for (size_t b = 0; b < batchCount; b++) freeMathState(mathStates + b);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#version 460 core
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexColor;
+
+#include "camera.glsl"
+
+struct DrawData {
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+out vec3 fragmentColor;
+
+void main() {
+    DrawData draw = draws[gl_DrawID];
+    gl_Position = vp * draw.model * vec4(vertexPosition, 1);
+    fragmentColor = vertexColor * draw.color.rgb;
+}
@@ -0,0 +1,12 @@
+// Shared by all programs, the engine binds it to SHADER_CAMERA_BINDING when a program is linked
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 vp;
+    mat4 invView;
+    mat4 invVp;
+    vec3 cameraPosition;
+    float cameraNear;
+    float cameraFar;
+    vec2 viewport;
+};
@@ -0,0 +1,25 @@
+#version 460 core
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexColor;
+
+struct Object {
+    mat4 model;
+    vec4 sphere;
+    vec4 color;
+    uint mesh;
+};
+
+#include "camera.glsl"
+
+layout(std430, binding = 1) readonly buffer Objects {
+    Object objects[];
+};
+
+out vec3 fragmentColor;
+
+void main() {
+    // The culling pass stores the object's index as the base instance of its command
+    Object object = objects[gl_BaseInstance];
+    gl_Position = vp * object.model * vec4(vertexPosition, 1);
+    fragmentColor = vertexColor * object.color.rgb;
+}
@@ -0,0 +1,16 @@
+#version 330 core
+#ifndef FLAT
+in vec3 fragmentColor;
+#endif
+
+out vec4 color;
+
+uniform vec4 tint;
+
+void main() {
+#ifdef FLAT
+    color = tint;
+#else
+    color = vec4(fragmentColor * tint.rgb, tint.a);
+#endif
+}
@@ -0,0 +1,16 @@
+#version 330 core
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexColor;
+
+out vec3 fragmentColor;
+
+#include "camera.glsl"
+
+layout(std140) uniform Object {
+    mat4 model;
+};
+
+void main() {
+    gl_Position = vp * model * vec4(vertexPosition, 1);
+    fragmentColor = vertexColor;
+}
@@ -1,12 +1,14 @@
 #version 330 core
 layout(location = 0) in vec3 vertexPosition;
 layout(location = 1) in vec3 vertexColor;
+layout(location = 4) in mat4 instanceModel;
+layout(location = 8) in vec3 instanceColor;
 
 out vec3 fragmentColor;
 
-uniform mat4 mvp;
+#include "camera.glsl"
 
 void main() {
-    gl_Position = mvp * vec4(vertexPosition, 1);
-    fragmentColor = vertexColor;
+    gl_Position = vp * instanceModel * vec4(vertexPosition, 1);
+    fragmentColor = vertexColor * instanceColor;
 }
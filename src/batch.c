@@ -0,0 +1,101 @@
+#include "batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "glstate.h"
+
+static void *grow(void *const array, size_t *const capacity, const size_t required, const size_t size) {
+    if (required <= *capacity) return array;
+    while (*capacity < required) *capacity = *capacity > 0 ? 2 * *capacity : 64;
+    return realloc(array, *capacity * size);
+}
+
+BatchRenderer *batch_allocate(const MeshAttributes attributes, const size_t drawCapacity) {
+    BatchRenderer *b = calloc(1, sizeof(BatchRenderer));
+    b->attributes = attributes;
+    b->vertexFloats = mesh_getVertexFloats(attributes);
+    b->drawCapacity = drawCapacity;
+    b->commands = malloc(drawCapacity * sizeof(DrawElementsIndirectCommand));
+    b->draws = malloc(drawCapacity * sizeof(BatchDrawData));
+
+    glGenBuffers(1, &b->commandBuffer);
+    gls_bindBuffer(GL_DRAW_INDIRECT_BUFFER, b->commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr) (drawCapacity * sizeof(DrawElementsIndirectCommand)), NULL,
+                 GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &b->drawBuffer);
+    gls_bindBuffer(GL_SHADER_STORAGE_BUFFER, b->drawBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr) (drawCapacity * sizeof(BatchDrawData)), NULL,
+                 GL_DYNAMIC_DRAW);
+    return b;
+}
+
+void batch_dispose(BatchRenderer *b) {
+    free(b->vertices);
+    free(b->indices);
+    free(b->meshes);
+    free(b->commands);
+    free(b->draws);
+    if (b->megabuffer != NULL) mesh_dispose(b->megabuffer);
+    const GLuint buffers[] = {b->commandBuffer, b->drawBuffer};
+    gls_deleteBuffers(2, buffers);
+    free(b);
+}
+
+uint32_t batch_addMesh(BatchRenderer *const b, const float vertices[], const size_t vertexCount,
+                       const uint32_t indices[], const size_t indexCount) {
+    b->vertices = grow(b->vertices, &b->vertexCapacity, b->vertexCount + vertexCount, b->vertexFloats * sizeof(float));
+    b->indices = grow(b->indices, &b->indexCapacity, b->indexCount + indexCount, sizeof(uint32_t));
+    b->meshes = grow(b->meshes, &b->meshCapacity, b->meshCount + 1, sizeof(BatchMesh));
+
+    // Indices stay relative to the mesh, the base vertex of its commands offsets them into the megabuffer
+    memcpy(b->vertices + b->vertexCount * b->vertexFloats, vertices, vertexCount * b->vertexFloats * sizeof(float));
+    memcpy(b->indices + b->indexCount, indices, indexCount * sizeof(uint32_t));
+    b->meshes[b->meshCount] = (BatchMesh) {(GLuint) b->indexCount, (GLuint) indexCount, (GLint) b->vertexCount};
+    b->vertexCount += vertexCount;
+    b->indexCount += indexCount;
+    return (uint32_t) b->meshCount++;
+}
+
+void batch_build(BatchRenderer *const b) {
+    b->megabuffer = mesh_uploadIndexed(b->attributes, b->vertices, b->vertexCount, b->indices, b->indexCount);
+    free(b->vertices);
+    free(b->indices);
+    b->vertices = NULL;
+    b->indices = NULL;
+}
+
+void batch_begin(BatchRenderer *const b) {
+    b->drawCount = 0;
+}
+
+void batch_draw(BatchRenderer *const b, const uint32_t mesh, const Matrix4f *const model,
+                const Vector4f *const color) {
+    if (b->drawCount == b->drawCapacity) return;
+    const BatchMesh *const m = b->meshes + mesh;
+    b->commands[b->drawCount] = (DrawElementsIndirectCommand) {
+        m->indexCount, 1, m->firstIndex, m->baseVertex, (GLuint) b->drawCount,
+    };
+    memcpy(b->draws[b->drawCount].model, model->t, sizeof(model->t));
+    b->draws[b->drawCount].color = *color;
+    b->drawCount++;
+}
+
+void batch_submit(const BatchRenderer *const b) {
+    if (b->drawCount == 0) return;
+
+    // Orphaning before the upload keeps the previous frame's draws from stalling it
+    gls_bindBuffer(GL_DRAW_INDIRECT_BUFFER, b->commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr) (b->drawCapacity * sizeof(DrawElementsIndirectCommand)), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, (GLsizeiptr) (b->drawCount * sizeof(DrawElementsIndirectCommand)),
+                    b->commands);
+    gls_bindBuffer(GL_SHADER_STORAGE_BUFFER, b->drawBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr) (b->drawCapacity * sizeof(BatchDrawData)), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr) (b->drawCount * sizeof(BatchDrawData)), b->draws);
+    gls_bindBufferBase(GL_SHADER_STORAGE_BUFFER, BATCH_DRAW_BINDING, b->drawBuffer);
+
+    gls_bindVertexArray(b->megabuffer->vao);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, (GLsizei) b->drawCount, 0);
+}
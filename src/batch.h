@@ -0,0 +1,89 @@
+#ifndef BATCH_H
+#define BATCH_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glad/glad.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+#include "mesh.h"
+
+/**
+ * Shader storage binding of the per-draw data, read by shaders as draws[gl_DrawID].
+ */
+#define BATCH_DRAW_BINDING 0
+
+/**
+ * Layout of glMultiDrawElementsIndirect commands.
+ */
+typedef struct {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+} DrawElementsIndirectCommand;
+
+/**
+ * Per-draw shader data, laid out as the std430 struct {mat4 model; vec4 color;}.
+ */
+typedef struct {
+    float model[4][4];
+    Vector4f color;
+} BatchDrawData;
+
+typedef struct {
+    GLuint firstIndex, indexCount;
+    GLint baseVertex;
+} BatchMesh;
+
+/**
+ * Draws many different indexed meshes with one glMultiDrawElementsIndirect call. Meshes are packed into shared
+ * vertex and index megabuffers by batch_addMesh and batch_build; every frame the draws are recorded with batch_draw
+ * and submitted with batch_submit. Needs OpenGL 4.6, the first version with gl_DrawID in core shaders.
+ */
+typedef struct {
+    MeshAttributes attributes;
+    size_t vertexFloats;
+    float *vertices;
+    size_t vertexCount, vertexCapacity;
+    uint32_t *indices;
+    size_t indexCount, indexCapacity;
+    BatchMesh *meshes;
+    size_t meshCount, meshCapacity;
+    Mesh *megabuffer;
+    GLuint commandBuffer, drawBuffer;
+    DrawElementsIndirectCommand *commands;
+    BatchDrawData *draws;
+    size_t drawCount, drawCapacity;
+} BatchRenderer;
+
+BatchRenderer *batch_allocate(MeshAttributes attributes, size_t drawCapacity);
+
+void batch_dispose(BatchRenderer *b);
+
+/**
+ * Appends an indexed mesh with interleaved vertices to the megabuffers and returns its id. Meshes can only be
+ * added before batch_build.
+ */
+uint32_t batch_addMesh(BatchRenderer *b, const float vertices[], size_t vertexCount, const uint32_t indices[],
+                       size_t indexCount);
+
+/**
+ * Uploads the megabuffers and frees their copies in memory.
+ */
+void batch_build(BatchRenderer *b);
+
+void batch_begin(BatchRenderer *b);
+
+/**
+ * Records a draw of a mesh. Draws past the capacity are dropped.
+ */
+void batch_draw(BatchRenderer *b, uint32_t mesh, const Matrix4f *model, const Vector4f *color);
+
+/**
+ * Uploads the recorded commands and draw data and draws them. The program reading the draw data must be in use.
+ */
+void batch_submit(const BatchRenderer *b);
+
+#endif //BATCH_H
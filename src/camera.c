@@ -1,6 +1,7 @@
 #include "camera.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 Camera *cam_allocate() {
     Camera *c = malloc(sizeof(Camera));
@@ -10,11 +11,18 @@ Camera *cam_allocate() {
     c->aspect = 0;
     c->position = calloc(2, sizeof(Vector3f));
     c->rotation = c->position + 1;
-    c->vp = calloc(5, sizeof(Matrix4f));
+    c->orientation = malloc(sizeof(Quatf));
+    quat_identity(c->orientation);
+    c->vp = aligned_alloc(_Alignof(Matrix4f), 7 * sizeof(Matrix4f));
+    memset(c->vp, 0, 7 * sizeof(Matrix4f));
     c->view = c->vp + 1;
     c->perspective = c->vp + 2;
     c->_posMat = c->vp + 3;
     c->_rotMat = c->vp + 4;
+    c->invView = c->vp + 5;
+    c->invVp = c->vp + 6;
+    c->frustum = malloc(sizeof(Frustum));
+    c->version = 0;
     c->_isPerMatUpdateNeeded = true;
     c->_isPosMatUpdateNeeded = true;
     c->_isRotMatUpdateNeeded = true;
@@ -23,6 +31,8 @@ Camera *cam_allocate() {
 
 void cam_dispose(Camera *c) {
     free(c->position);
+    free(c->orientation);
+    free(c->frustum);
     free(c->vp);
     free(c);
 }
@@ -39,6 +49,19 @@ void cam_rotate(Camera *const c, const float x, const float y, const float z) {
     c->rotation->x += -x;
     c->rotation->y += -y;
     c->rotation->z += -z;
+    quat_fromEuler(c->orientation, c->rotation);
+}
+
+void cam_setOrientation(Camera *const c, const Quatf *const orientation) {
+    c->_isRotMatUpdateNeeded = true;
+    *c->orientation = *orientation;
+}
+
+void cam_rotateQuat(Camera *const c, const Quatf *const delta) {
+    c->_isRotMatUpdateNeeded = true;
+    quat_mult(delta, c->orientation, c->orientation);
+    // Keeps rounding errors of repeated composition from scaling the view
+    quat_normalize(c->orientation, c->orientation);
 }
 
 void cam_setPrefs(Camera *const c, const float fov, const float near, const float far) {
@@ -48,7 +71,12 @@ void cam_setPrefs(Camera *const c, const float fov, const float near, const floa
     c->far = far;
 }
 
-void cam_updateMatrices(Camera *const c) {
+void cam_setAspect(Camera *const c, const float aspect) {
+    c->_isPerMatUpdateNeeded = true;
+    c->aspect = aspect;
+}
+
+bool cam_updateMatrices(Camera *const c) {
     bool isUpdateNeeded = false;
     bool isViewMatUpdateNeeded = false;
 
@@ -58,7 +86,7 @@ void cam_updateMatrices(Camera *const c) {
         isViewMatUpdateNeeded = true;
     }
     if (c->_isRotMatUpdateNeeded) {
-        mat_rotation(c->_rotMat, c->rotation);
+        mat_rotationQuat(c->_rotMat, c->orientation);
         c->_isRotMatUpdateNeeded = false;
         isViewMatUpdateNeeded = true;
     }
@@ -70,7 +98,14 @@ void cam_updateMatrices(Camera *const c) {
 
     if (isViewMatUpdateNeeded) {
         mat_multMat4f(c->_rotMat, c->_posMat, c->view);
+        mat_inverseRigid(c->view, c->invView);
         isUpdateNeeded = true;
     }
-    if (isUpdateNeeded) mat_multMat4f(c->perspective, c->view, c->vp);
+    if (isUpdateNeeded) {
+        mat_multMat4f(c->perspective, c->view, c->vp);
+        mat_inverse(c->vp, c->invVp);
+        cull_extractFrustum(c->vp, c->frustum);
+        c->version++;
+    }
+    return isUpdateNeeded;
 }
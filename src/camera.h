@@ -1,17 +1,35 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 #include <stdbool.h>
+#include <stdint.h>
 
+#include "math/culling.h"
 #include "math/matrix.h"
+#include "math/quaternion.h"
 #include "math/vector.h"
 
 typedef struct {
     Vector3f *position;
+    /**
+     * Euler angles accumulated by cam_rotate. The view is built from orientation, which cam_rotate keeps in sync;
+     * cam_setOrientation leaves these angles as they were.
+     */
     Vector3f *rotation;
+    Quatf *orientation;
     float fov, near, far, aspect;
     Matrix4f *vp;
     Matrix4f *perspective;
     Matrix4f *view;
+    Matrix4f *invView;
+    Matrix4f *invVp;
+    /**
+     * Planes of vp, extracted by cam_updateMatrices whenever it recomputes vp.
+     */
+    Frustum *frustum;
+    /**
+     * Incremented by cam_updateMatrices whenever it recomputes the matrices, lets their users skip unchanged frames.
+     */
+    uint32_t version;
     Matrix4f *_posMat;
     Matrix4f *_rotMat;
     bool _isPerMatUpdateNeeded;
@@ -27,8 +45,17 @@ void cam_move(Camera *c, float x, float y, float z);
 
 void cam_rotate(Camera *c, float x, float y, float z);
 
+void cam_setOrientation(Camera *c, const Quatf *orientation);
+
+void cam_rotateQuat(Camera *c, const Quatf *delta);
+
 void cam_setPrefs(Camera *c, float fov, float near, float far);
 
-void cam_updateMatrices(Camera *c);
+void cam_setAspect(Camera *c, float aspect);
+
+/**
+ * Recomputes the matrices that are out of date. Returns true if any of them changed.
+ */
+bool cam_updateMatrices(Camera *c);
 
 #endif //CAMERA_H
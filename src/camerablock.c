@@ -0,0 +1,53 @@
+#include "camerablock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "glstate.h"
+#include "shader.h"
+
+CameraBlock *camblock_allocate() {
+    CameraBlock *b = calloc(1, sizeof(CameraBlock));
+    b->isUploadNeeded = true;
+    glGenBuffers(1, &b->buffer);
+    gls_bindBuffer(GL_UNIFORM_BUFFER, b->buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlockData), NULL, GL_DYNAMIC_DRAW);
+    return b;
+}
+
+void camblock_dispose(CameraBlock *b) {
+    gls_deleteBuffers(1, &b->buffer);
+    free(b);
+}
+
+void camblock_setViewport(CameraBlock *const b, const float width, const float height) {
+    if (b->viewport[0] == width && b->viewport[1] == height) return;
+    b->viewport[0] = width;
+    b->viewport[1] = height;
+    b->isUploadNeeded = true;
+}
+
+void camblock_update(CameraBlock *const b, Camera *const camera) {
+    cam_updateMatrices(camera);
+    if (b->isUploadNeeded || b->cameraVersion != camera->version) {
+        CameraBlockData data;
+        memcpy(data.view, camera->view->t, sizeof(data.view));
+        memcpy(data.projection, camera->perspective->t, sizeof(data.projection));
+        memcpy(data.vp, camera->vp->t, sizeof(data.vp));
+        memcpy(data.invView, camera->invView->t, sizeof(data.invView));
+        memcpy(data.invVp, camera->invVp->t, sizeof(data.invVp));
+        // The eye is where the inverse view takes the origin
+        memcpy(data.position, camera->invView->t[3], sizeof(data.position));
+        data.near = camera->near;
+        data.far = camera->far;
+        data._pad = 0.0f;
+        memcpy(data.viewport, b->viewport, sizeof(data.viewport));
+
+        gls_bindBuffer(GL_UNIFORM_BUFFER, b->buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlockData), &data);
+        b->cameraVersion = camera->version;
+        b->isUploadNeeded = false;
+        b->uploads++;
+    }
+    gls_bindBufferBase(GL_UNIFORM_BUFFER, SHADER_CAMERA_BINDING, b->buffer);
+}
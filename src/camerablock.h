@@ -0,0 +1,53 @@
+#ifndef CAMERABLOCK_H
+#define CAMERABLOCK_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "camera.h"
+#include "glad/glad.h"
+
+/**
+ * Contents of the Camera uniform block, laid out as the std140 block
+ * {mat4 view, projection, vp, invView, invVp; vec3 cameraPosition; float cameraNear, cameraFar; vec2 viewport;}.
+ */
+typedef struct {
+    float view[4][4];
+    float projection[4][4];
+    float vp[4][4];
+    float invView[4][4];
+    float invVp[4][4];
+    float position[3];
+    float near;
+    float far;
+    float _pad;
+    float viewport[2];
+} CameraBlockData;
+
+/**
+ * The camera uniform block shared by every program, bound at SHADER_CAMERA_BINDING. It is uploaded only when the
+ * camera's matrices or the viewport changed since the last upload.
+ */
+typedef struct {
+    GLuint buffer;
+    uint32_t cameraVersion;
+    float viewport[2];
+    bool isUploadNeeded;
+    /**
+     * Uploads since the block was allocated.
+     */
+    size_t uploads;
+} CameraBlock;
+
+CameraBlock *camblock_allocate();
+
+void camblock_dispose(CameraBlock *b);
+
+void camblock_setViewport(CameraBlock *b, float width, float height);
+
+/**
+ * Updates the camera's matrices, uploads them if they changed and binds the block. Meant to be called once per frame
+ * in place of cam_updateMatrices.
+ */
+void camblock_update(CameraBlock *b, Camera *camera);
+
+#endif //CAMERABLOCK_H
@@ -0,0 +1,91 @@
+#include "compute.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "glstate.h"
+#include "shader.h"
+#include "utility/log.h"
+
+__attribute__ ((format(printf, 2, 3)))
+static void llog(const char *const level, char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    glog(level, format, "compute", args);
+    va_end(args);
+}
+
+static void readGroupSize(ComputeProgram *const p, const GLuint program) {
+    p->program = program;
+    GLint groupSize[3];
+    glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, groupSize);
+    for (int i = 0; i < 3; i++) p->groupSize[i] = (GLuint) groupSize[i];
+}
+
+ComputeProgram *comp_load(const char *const filename) {
+    if (!GLAD_GL_VERSION_4_3) {
+        llog(ERROR, "Compute shaders need OpenGL 4.3: %s", filename);
+        return NULL;
+    }
+    if (shader_getType(filename) != GL_COMPUTE_SHADER) {
+        llog(ERROR, "Not a compute shader: %s", filename);
+        return NULL;
+    }
+    const GLuint program = shader_loadProgram(&filename, 1);
+    if (program == 0) return NULL;
+
+    ComputeProgram *p = malloc(sizeof(ComputeProgram));
+    readGroupSize(p, program);
+    llog(INFO, "Loaded (%s) with %ux%ux%u work groups", filename, p->groupSize[0], p->groupSize[1], p->groupSize[2]);
+    return p;
+}
+
+void comp_dispose(ComputeProgram *p) {
+    glDeleteProgram(p->program);
+    free(p);
+}
+
+void comp_replaceProgram(ComputeProgram *const p, const GLuint program) {
+    glDeleteProgram(p->program);
+    readGroupSize(p, program);
+}
+
+void comp_dispatch(const ComputeProgram *const p, const GLuint x, const GLuint y, const GLuint z) {
+    gls_useProgram(p->program);
+    glDispatchCompute(x, y, z);
+}
+
+static GLuint groupsFor(const size_t invocations, const GLuint groupSize) {
+    return (GLuint) ((invocations + groupSize - 1) / groupSize);
+}
+
+void comp_dispatchInvocations(const ComputeProgram *const p, const size_t x, const size_t y, const size_t z) {
+    comp_dispatch(p, groupsFor(x, p->groupSize[0]), groupsFor(y, p->groupSize[1]), groupsFor(z, p->groupSize[2]));
+}
+
+void comp_dispatchIndirect(const ComputeProgram *const p, const GLuint buffer, const GLintptr offset) {
+    gls_useProgram(p->program);
+    gls_bindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffer);
+    glDispatchComputeIndirect(offset);
+}
+
+void comp_barrier(const ComputeBarrier barriers) {
+    glMemoryBarrier((GLbitfield) barriers);
+}
+
+void comp_bindStorage(const GLuint binding, const GLuint buffer) {
+    gls_bindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
+
+void comp_bindStorageRange(const GLuint binding, const GLuint buffer, const GLintptr offset, const GLsizeiptr size) {
+    gls_bindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+}
+
+void comp_bindUniforms(const GLuint binding, const GLuint buffer) {
+    gls_bindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+}
+
+void comp_bindImage(const GLuint unit, const GLuint texture, const GLint level, const GLenum access,
+                    const GLenum format) {
+    glBindImageTexture(unit, texture, level, GL_TRUE, 0, access, format);
+}
@@ -0,0 +1,89 @@
+#ifndef COMPUTE_H
+#define COMPUTE_H
+#include <stddef.h>
+
+#include "glad/glad.h"
+
+/**
+ * What a dispatch's writes must be visible to, passed to comp_barrier.
+ */
+typedef enum {
+    /**
+     * Shader storage reads and writes of later draws and dispatches.
+     */
+    COMP_BARRIER_STORAGE = GL_SHADER_STORAGE_BARRIER_BIT,
+    /**
+     * Indirect draw and dispatch arguments, including the count of glMultiDrawElementsIndirectCount.
+     */
+    COMP_BARRIER_COMMANDS = GL_COMMAND_BARRIER_BIT,
+    COMP_BARRIER_VERTICES = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT,
+    COMP_BARRIER_UNIFORMS = GL_UNIFORM_BARRIER_BIT,
+    /**
+     * Image loads and stores of later draws and dispatches.
+     */
+    COMP_BARRIER_IMAGES = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT,
+    /**
+     * Texture sampling of images written by a dispatch.
+     */
+    COMP_BARRIER_TEXTURES = GL_TEXTURE_FETCH_BARRIER_BIT,
+    /**
+     * glGetBufferSubData, glMapBufferRange and buffer copies.
+     */
+    COMP_BARRIER_BUFFER_READS = GL_BUFFER_UPDATE_BARRIER_BIT,
+} ComputeBarrier;
+
+/**
+ * A compute shader linked into its own program, with the work group size it declares.
+ */
+typedef struct {
+    GLuint program;
+    GLuint groupSize[3];
+} ComputeProgram;
+
+/**
+ * Reads, compiles and links a .comp file from the shader directory. Returns NULL and logs the reason if that fails
+ * or the context has no compute shaders, which came with OpenGL 4.3.
+ */
+ComputeProgram *comp_load(const char *filename);
+
+void comp_dispose(ComputeProgram *p);
+
+/**
+ * Deletes the program for a rebuilt one, which may declare another work group size.
+ */
+void comp_replaceProgram(ComputeProgram *p, GLuint program);
+
+/**
+ * Uses the program and dispatches x * y * z work groups.
+ */
+void comp_dispatch(const ComputeProgram *p, GLuint x, GLuint y, GLuint z);
+
+/**
+ * Uses the program and dispatches enough work groups to cover x * y * z invocations. Shaders must skip the
+ * invocations past the end of the last groups.
+ */
+void comp_dispatchInvocations(const ComputeProgram *p, size_t x, size_t y, size_t z);
+
+/**
+ * Uses the program and dispatches the work group counts stored as three GLuints at offset in buffer.
+ */
+void comp_dispatchIndirect(const ComputeProgram *p, GLuint buffer, GLintptr offset);
+
+/**
+ * Makes the writes of earlier dispatches visible to the uses in barriers, a combination of ComputeBarrier values.
+ */
+void comp_barrier(ComputeBarrier barriers);
+
+void comp_bindStorage(GLuint binding, GLuint buffer);
+
+void comp_bindStorageRange(GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+void comp_bindUniforms(GLuint binding, GLuint buffer);
+
+/**
+ * Binds a level of a texture to an image unit. access is GL_READ_ONLY, GL_WRITE_ONLY or GL_READ_WRITE, format
+ * the image format the shader declares, such as GL_RGBA8 or GL_R32F. Layered textures are bound whole.
+ */
+void comp_bindImage(GLuint unit, GLuint texture, GLint level, GLenum access, GLenum format);
+
+#endif //COMPUTE_H
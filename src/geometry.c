@@ -0,0 +1,293 @@
+#include "geometry.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "math/vector.h"
+
+#define GEO_NONE UINT32_MAX
+
+static uint32_t hashVertex(const float *const vertex, const size_t vertexFloats) {
+    // FNV-1a over the bytes, so vertices are equal exactly when their bits are
+    const unsigned char *const bytes = (const unsigned char *) vertex;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < vertexFloats * sizeof(float); i++) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+size_t geo_weld(const float vertices[], const size_t vertexCount, const size_t vertexFloats, float resVertices[],
+                uint32_t resIndices[]) {
+    size_t tableSize = 1;
+    while (tableSize < 2 * vertexCount) tableSize *= 2;
+    uint32_t *table = malloc(tableSize * sizeof(uint32_t));
+    memset(table, 0xff, tableSize * sizeof(uint32_t));
+
+    const size_t vertexSize = vertexFloats * sizeof(float);
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < vertexCount; i++) {
+        const float *const vertex = vertices + i * vertexFloats;
+        size_t bucket = hashVertex(vertex, vertexFloats) & (tableSize - 1);
+        while (table[bucket] != GEO_NONE &&
+               memcmp(resVertices + table[bucket] * vertexFloats, vertex, vertexSize) != 0) {
+            bucket = (bucket + 1) & (tableSize - 1);
+        }
+        if (table[bucket] == GEO_NONE) {
+            // The unique vertex never lands after the input one, so welding in place only moves vertices forward
+            if (resVertices + uniqueCount * vertexFloats != vertex) {
+                memcpy(resVertices + uniqueCount * vertexFloats, vertex, vertexSize);
+            }
+            table[bucket] = (uint32_t) uniqueCount++;
+        }
+        resIndices[i] = table[bucket];
+    }
+
+    free(table);
+    return uniqueCount;
+}
+
+GeoCacheStats geo_analyzeVertexCache(const uint32_t indices[], const size_t indexCount, const size_t vertexCount,
+                                     const uint32_t cacheSize) {
+    // A vertex is in the FIFO while fewer than cacheSize vertices were added after it
+    uint32_t *cacheTimes = calloc(vertexCount, sizeof(uint32_t));
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        const uint32_t v = indices[i];
+        if (time - cacheTimes[v] > cacheSize) {
+            cacheTimes[v] = time++;
+            misses++;
+        }
+    }
+    free(cacheTimes);
+
+    const size_t triangleCount = indexCount / 3;
+    return (GeoCacheStats) {
+        triangleCount > 0 ? (float) misses / (float) triangleCount : 0.0f,
+        vertexCount > 0 ? (float) misses / (float) vertexCount : 0.0f,
+    };
+}
+
+typedef struct {
+    const uint32_t *indices;
+    uint32_t *offsets;
+    uint32_t *adjacency;
+    uint32_t *live;
+    uint32_t *cacheTimes;
+    uint32_t *deadEnd;
+    size_t deadEndCount;
+    uint32_t *candidates;
+    size_t candidateCount;
+    size_t vertexCount;
+    uint32_t cursor;
+    uint32_t time;
+    uint32_t cacheSize;
+} Tipsify;
+
+static uint32_t skipDeadEnd(Tipsify *const t) {
+    while (t->deadEndCount > 0) {
+        const uint32_t v = t->deadEnd[--t->deadEndCount];
+        if (t->live[v] > 0) return v;
+    }
+    for (; t->cursor < t->vertexCount; t->cursor++) {
+        if (t->live[t->cursor] > 0) return t->cursor;
+    }
+    return GEO_NONE;
+}
+
+/**
+ * Picks the candidate that stays in the cache the longest while all its remaining triangles are emitted.
+ */
+static uint32_t getNextVertex(Tipsify *const t) {
+    uint32_t next = GEO_NONE;
+    int64_t bestPriority = -1;
+    for (size_t i = 0; i < t->candidateCount; i++) {
+        const uint32_t v = t->candidates[i];
+        if (t->live[v] == 0) continue;
+        int64_t priority = 0;
+        const uint32_t age = t->time - t->cacheTimes[v];
+        if (age + 2 * t->live[v] <= t->cacheSize) priority = age;
+        if (priority > bestPriority) {
+            bestPriority = priority;
+            next = v;
+        }
+    }
+    return next != GEO_NONE ? next : skipDeadEnd(t);
+}
+
+void geo_optimizeVertexCache(uint32_t indices[], const size_t indexCount, const size_t vertexCount,
+                             const uint32_t cacheSize) {
+    if (indexCount == 0) return;
+    const size_t triangleCount = indexCount / 3;
+
+    Tipsify t = {
+        indices,
+        calloc(vertexCount + 1, sizeof(uint32_t)),
+        malloc(indexCount * sizeof(uint32_t)),
+        calloc(vertexCount, sizeof(uint32_t)),
+        calloc(vertexCount, sizeof(uint32_t)),
+        malloc(indexCount * sizeof(uint32_t)),
+        0,
+        malloc(indexCount * sizeof(uint32_t)),
+        0,
+        vertexCount,
+        0,
+        cacheSize + 1,
+        cacheSize,
+    };
+    bool *isEmitted = calloc(triangleCount, sizeof(bool));
+    uint32_t *res = malloc(indexCount * sizeof(uint32_t));
+
+    // Triangles around every vertex, the live counts double as fill cursors
+    for (size_t i = 0; i < 3 * triangleCount; i++) t.offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++) t.offsets[v + 1] += t.offsets[v];
+    for (size_t i = 0; i < 3 * triangleCount; i++) {
+        const uint32_t v = indices[i];
+        t.adjacency[t.offsets[v] + t.live[v]++] = (uint32_t) (i / 3);
+    }
+
+    size_t resCount = 0;
+    uint32_t fan = indices[0];
+    while (fan != GEO_NONE) {
+        t.candidateCount = 0;
+        for (uint32_t a = t.offsets[fan]; a < t.offsets[fan + 1]; a++) {
+            const uint32_t triangle = t.adjacency[a];
+            if (isEmitted[triangle]) continue;
+            for (int c = 0; c < 3; c++) {
+                const uint32_t v = indices[3 * triangle + c];
+                res[resCount++] = v;
+                t.deadEnd[t.deadEndCount++] = v;
+                t.candidates[t.candidateCount++] = v;
+                t.live[v]--;
+                if (t.time - t.cacheTimes[v] > cacheSize) t.cacheTimes[v] = t.time++;
+            }
+            isEmitted[triangle] = true;
+        }
+        fan = getNextVertex(&t);
+    }
+    memcpy(indices, res, resCount * sizeof(uint32_t));
+
+    free(t.offsets);
+    free(t.adjacency);
+    free(t.live);
+    free(t.cacheTimes);
+    free(t.deadEnd);
+    free(t.candidates);
+    free(isEmitted);
+    free(res);
+}
+
+typedef struct {
+    uint32_t first, count;
+    float score;
+} Cluster;
+
+static int compareClusters(const void *const a, const void *const b) {
+    const Cluster *const l = a;
+    const Cluster *const r = b;
+    if (l->score != r->score) return l->score < r->score ? 1 : -1;
+    return (l->first > r->first) - (l->first < r->first);
+}
+
+static Vector3f getPosition(const float vertices[], const size_t vertexFloats, const uint32_t v) {
+    const float *const p = vertices + v * vertexFloats;
+    return (Vector3f) {p[0], p[1], p[2]};
+}
+
+void geo_optimizeOverdraw(uint32_t indices[], const size_t indexCount, const float vertices[],
+                          const size_t vertexCount, const size_t vertexFloats, const uint32_t cacheSize) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    // A triangle missing the cache with all three vertices starts a cluster
+    Cluster *clusters = malloc(triangleCount * sizeof(Cluster));
+    size_t clusterCount = 0;
+    uint32_t *cacheTimes = calloc(vertexCount, sizeof(uint32_t));
+    uint32_t time = cacheSize + 1;
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        int misses = 0;
+        for (int c = 0; c < 3; c++) {
+            const uint32_t v = indices[3 * triangle + c];
+            if (time - cacheTimes[v] > cacheSize) {
+                cacheTimes[v] = time++;
+                misses++;
+            }
+        }
+        if (misses == 3 || clusterCount == 0) clusters[clusterCount++] = (Cluster) {triangle, 0, 0.0f};
+        clusters[clusterCount - 1].count++;
+    }
+    free(cacheTimes);
+
+    // Area weighted centroids and normals; clusters facing away from the mesh center are drawn first
+    Vector3f *centroids = malloc(clusterCount * sizeof(Vector3f));
+    Vector3f *normals = malloc(clusterCount * sizeof(Vector3f));
+    Vector3f meshCentroid = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    for (size_t i = 0; i < clusterCount; i++) {
+        Vector3f centroid = {0.0f, 0.0f, 0.0f}, normal = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (uint32_t triangle = clusters[i].first; triangle < clusters[i].first + clusters[i].count; triangle++) {
+            const Vector3f a = getPosition(vertices, vertexFloats, indices[3 * triangle]);
+            const Vector3f b = getPosition(vertices, vertexFloats, indices[3 * triangle + 1]);
+            const Vector3f c = getPosition(vertices, vertexFloats, indices[3 * triangle + 2]);
+            Vector3f ab, ac, cross, center;
+            vec_sub3f(&b, &a, &ab);
+            vec_sub3f(&c, &a, &ac);
+            vec_cross3f(&ab, &ac, &cross);
+            const float triangleArea = vec_length3f(&cross) * 0.5f;
+            vec_add3f(&a, &b, &center);
+            vec_add3f(&center, &c, &center);
+            vec_multNum3f(&center, triangleArea / 3.0f, &center);
+            vec_add3f(&centroid, &center, &centroid);
+            vec_add3f(&normal, &cross, &normal);
+            area += triangleArea;
+        }
+        vec_add3f(&meshCentroid, &centroid, &meshCentroid);
+        meshArea += area;
+        vec_multNum3f(&centroid, area > 0.0f ? 1.0f / area : 0.0f, centroids + i);
+        vec_normalize3f(&normal, normals + i);
+    }
+    vec_multNum3f(&meshCentroid, meshArea > 0.0f ? 1.0f / meshArea : 0.0f, &meshCentroid);
+    for (size_t i = 0; i < clusterCount; i++) {
+        Vector3f outward;
+        vec_sub3f(centroids + i, &meshCentroid, &outward);
+        clusters[i].score = vec_dot3f(&outward, normals + i);
+    }
+    qsort(clusters, clusterCount, sizeof(Cluster), compareClusters);
+
+    uint32_t *res = malloc(3 * triangleCount * sizeof(uint32_t));
+    size_t resCount = 0;
+    for (size_t i = 0; i < clusterCount; i++) {
+        memcpy(res + resCount, indices + 3 * clusters[i].first, 3 * clusters[i].count * sizeof(uint32_t));
+        resCount += 3 * clusters[i].count;
+    }
+    memcpy(indices, res, resCount * sizeof(uint32_t));
+
+    free(clusters);
+    free(centroids);
+    free(normals);
+    free(res);
+}
+
+size_t geo_optimizeVertexFetch(float vertices[], const size_t vertexCount, const size_t vertexFloats,
+                               uint32_t indices[], const size_t indexCount) {
+    uint32_t *remap = malloc(vertexCount * sizeof(uint32_t));
+    memset(remap, 0xff, vertexCount * sizeof(uint32_t));
+    uint32_t usedCount = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        const uint32_t v = indices[i];
+        if (remap[v] == GEO_NONE) remap[v] = usedCount++;
+        indices[i] = remap[v];
+    }
+
+    const size_t vertexSize = vertexFloats * sizeof(float);
+    float *original = malloc(vertexCount * vertexSize);
+    memcpy(original, vertices, vertexCount * vertexSize);
+    for (size_t v = 0; v < vertexCount; v++) {
+        if (remap[v] != GEO_NONE) memcpy(vertices + remap[v] * vertexFloats, original + v * vertexFloats, vertexSize);
+    }
+
+    free(remap);
+    free(original);
+    return usedCount;
+}
@@ -0,0 +1,59 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Mesh processing on interleaved float vertices, vertexFloats floats each with the position in the first three,
+ * and triangle lists of 32-bit indices. Meant to run once, when a mesh is built or imported.
+ */
+
+/**
+ * Post-transform vertex cache size assumed by the optimizations and the statistics.
+ */
+#define GEO_CACHE_SIZE 16
+
+typedef struct {
+    /**
+     * Average cache miss ratio, transformed vertices per triangle: 0.5 at best for large meshes, 3 at worst.
+     */
+    float acmr;
+    /**
+     * Average transform to vertex ratio, transformed vertices per vertex: 1 at best.
+     */
+    float atvr;
+} GeoCacheStats;
+
+/**
+ * Merges bitwise identical vertices. Writes the unique vertices to resVertices in order of first appearance and
+ * one index per input vertex to resIndices, and returns the number of unique vertices. resVertices may be vertices.
+ */
+size_t geo_weld(const float vertices[], size_t vertexCount, size_t vertexFloats, float resVertices[],
+                uint32_t resIndices[]);
+
+/**
+ * Simulates a FIFO vertex cache of cacheSize entries over the triangle list.
+ */
+GeoCacheStats geo_analyzeVertexCache(const uint32_t indices[], size_t indexCount, size_t vertexCount,
+                                     uint32_t cacheSize);
+
+/**
+ * Reorders triangles for the post-transform vertex cache with Tipsify (Sander et al. 2007).
+ */
+void geo_optimizeVertexCache(uint32_t indices[], size_t indexCount, size_t vertexCount, uint32_t cacheSize);
+
+/**
+ * Reorders clusters of a cache-optimized triangle list so that outward facing ones, which are likely to occlude
+ * the rest, come first. Clusters start where the cache is cold, so the cache efficiency is kept.
+ */
+void geo_optimizeOverdraw(uint32_t indices[], size_t indexCount, const float vertices[], size_t vertexCount,
+                          size_t vertexFloats, uint32_t cacheSize);
+
+/**
+ * Reorders vertices by first use in the triangle list and remaps the indices. Vertices no triangle uses are dropped;
+ * returns the new vertex count.
+ */
+size_t geo_optimizeVertexFetch(float vertices[], size_t vertexCount, size_t vertexFloats, uint32_t indices[],
+                               size_t indexCount);
+
+#endif //GEOMETRY_H
@@ -0,0 +1,222 @@
+#include "glstate.h"
+
+#include <string.h>
+
+/**
+ * Shadowed values equal to this, or -1 for the signed ones, are unknown and never match a call.
+ */
+#define UNKNOWN UINT32_MAX
+
+typedef struct {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+} IndexedBinding;
+
+static const GLenum bufferTargets[] = {
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_DRAW_INDIRECT_BUFFER,
+    GL_DISPATCH_INDIRECT_BUFFER, GL_PARAMETER_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+    GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_ATOMIC_COUNTER_BUFFER, GL_TEXTURE_BUFFER, GL_QUERY_BUFFER,
+};
+#define BUFFER_TARGET_COUNT (sizeof(bufferTargets) / sizeof(bufferTargets[0]))
+
+static const GLenum textureTargets[] = {
+    GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_MULTISAMPLE,
+};
+#define TEXTURE_TARGET_COUNT (sizeof(textureTargets) / sizeof(textureTargets[0]))
+
+static struct {
+    GLuint program, vertexArray;
+    GLuint buffers[BUFFER_TARGET_COUNT];
+    IndexedBinding uniformBindings[GLS_BUFFER_BINDINGS], storageBindings[GLS_BUFFER_BINDINGS];
+    GLuint activeUnit;
+    GLuint textures[GLS_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    GLuint samplers[GLS_TEXTURE_UNITS];
+    GLint isBlendEnabled, isDepthTestEnabled, isDepthWritten;
+    GLenum blendSource, blendDestination, depthFunc;
+    GLint viewport[4];
+} state;
+
+GlStateStats gls_stats;
+
+void gls_invalidate() {
+    memset(&state, 0xFF, sizeof(state));
+}
+
+void gls_resetStats() {
+    gls_stats = (GlStateStats) {0, 0};
+}
+
+/**
+ * Counts a call and returns true if it would change nothing.
+ */
+static bool isRedundant(const bool isUnchanged) {
+    gls_stats.calls++;
+    if (isUnchanged) gls_stats.skipped++;
+    return isUnchanged;
+}
+
+static GLuint *findBuffer(const GLenum target) {
+    for (size_t i = 0; i < BUFFER_TARGET_COUNT; i++) {
+        if (bufferTargets[i] == target) return state.buffers + i;
+    }
+    return NULL;
+}
+
+static IndexedBinding *findIndexedBinding(const GLenum target, const GLuint index) {
+    if (index >= GLS_BUFFER_BINDINGS) return NULL;
+    if (target == GL_UNIFORM_BUFFER) return state.uniformBindings + index;
+    if (target == GL_SHADER_STORAGE_BUFFER) return state.storageBindings + index;
+    return NULL;
+}
+
+static GLuint *findTexture(const GLuint unit, const GLenum target) {
+    if (unit >= GLS_TEXTURE_UNITS) return NULL;
+    for (size_t i = 0; i < TEXTURE_TARGET_COUNT; i++) {
+        if (textureTargets[i] == target) return state.textures[unit] + i;
+    }
+    return NULL;
+}
+
+void gls_useProgram(const GLuint program) {
+    if (isRedundant(state.program == program)) return;
+    state.program = program;
+    glUseProgram(program);
+}
+
+void gls_bindVertexArray(const GLuint vertexArray) {
+    if (isRedundant(state.vertexArray == vertexArray)) return;
+    state.vertexArray = vertexArray;
+    *findBuffer(GL_ELEMENT_ARRAY_BUFFER) = UNKNOWN;
+    glBindVertexArray(vertexArray);
+}
+
+void gls_bindBuffer(const GLenum target, const GLuint buffer) {
+    GLuint *const bound = findBuffer(target);
+    if (isRedundant(bound != NULL && *bound == buffer)) return;
+    if (bound != NULL) *bound = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void gls_bindBufferBase(const GLenum target, const GLuint index, const GLuint buffer) {
+    IndexedBinding *const binding = findIndexedBinding(target, index);
+    if (isRedundant(binding != NULL && binding->buffer == buffer && binding->size == 0)) return;
+    if (binding != NULL) *binding = (IndexedBinding) {buffer, 0, 0};
+    GLuint *const bound = findBuffer(target);
+    if (bound != NULL) *bound = buffer;
+    glBindBufferBase(target, index, buffer);
+}
+
+void gls_bindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset,
+                         const GLsizeiptr size) {
+    IndexedBinding *const binding = findIndexedBinding(target, index);
+    if (isRedundant(binding != NULL && binding->buffer == buffer && binding->offset == offset &&
+                    binding->size == size)) {
+        return;
+    }
+    if (binding != NULL) *binding = (IndexedBinding) {buffer, offset, size};
+    GLuint *const bound = findBuffer(target);
+    if (bound != NULL) *bound = buffer;
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void gls_bindTexture(const GLuint unit, const GLenum target, const GLuint texture) {
+    GLuint *const bound = findTexture(unit, target);
+    if (isRedundant(bound != NULL && *bound == texture)) return;
+    if (bound != NULL) *bound = texture;
+    if (state.activeUnit != unit) {
+        state.activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    glBindTexture(target, texture);
+}
+
+void gls_bindSampler(const GLuint unit, const GLuint sampler) {
+    const bool isShadowed = unit < GLS_TEXTURE_UNITS;
+    if (isRedundant(isShadowed && state.samplers[unit] == sampler)) return;
+    if (isShadowed) state.samplers[unit] = sampler;
+    glBindSampler(unit, sampler);
+}
+
+static void setCapability(GLint *const shadow, const GLenum capability, const bool isEnabled) {
+    if (isRedundant(*shadow == isEnabled)) return;
+    *shadow = isEnabled;
+    if (isEnabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void gls_setBlend(const bool isEnabled) {
+    setCapability(&state.isBlendEnabled, GL_BLEND, isEnabled);
+}
+
+void gls_blendFunc(const GLenum source, const GLenum destination) {
+    if (isRedundant(state.blendSource == source && state.blendDestination == destination)) return;
+    state.blendSource = source;
+    state.blendDestination = destination;
+    glBlendFunc(source, destination);
+}
+
+void gls_setDepthTest(const bool isEnabled) {
+    setCapability(&state.isDepthTestEnabled, GL_DEPTH_TEST, isEnabled);
+}
+
+void gls_depthFunc(const GLenum func) {
+    if (isRedundant(state.depthFunc == func)) return;
+    state.depthFunc = func;
+    glDepthFunc(func);
+}
+
+void gls_depthMask(const bool isWritten) {
+    if (isRedundant(state.isDepthWritten == isWritten)) return;
+    state.isDepthWritten = isWritten;
+    glDepthMask(isWritten ? GL_TRUE : GL_FALSE);
+}
+
+void gls_viewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height) {
+    GLint *const v = state.viewport;
+    if (isRedundant(v[0] == x && v[1] == y && v[2] == width && v[3] == height)) return;
+    v[0] = x;
+    v[1] = y;
+    v[2] = width;
+    v[3] = height;
+    glViewport(x, y, width, height);
+}
+
+void gls_deleteVertexArrays(const GLsizei count, const GLuint vertexArrays[]) {
+    for (GLsizei i = 0; i < count; i++) {
+        // GL falls back to the default vertex array when the bound one is deleted
+        if (state.vertexArray == vertexArrays[i]) {
+            state.vertexArray = 0;
+            *findBuffer(GL_ELEMENT_ARRAY_BUFFER) = UNKNOWN;
+        }
+    }
+    glDeleteVertexArrays(count, vertexArrays);
+}
+
+void gls_deleteBuffers(const GLsizei count, const GLuint buffers[]) {
+    // GL resets every binding of a deleted buffer to 0, indexed ones included
+    for (GLsizei i = 0; i < count; i++) {
+        for (size_t t = 0; t < BUFFER_TARGET_COUNT; t++) {
+            if (state.buffers[t] == buffers[i]) state.buffers[t] = 0;
+        }
+        for (size_t b = 0; b < GLS_BUFFER_BINDINGS; b++) {
+            if (state.uniformBindings[b].buffer == buffers[i]) state.uniformBindings[b] = (IndexedBinding) {0, 0, 0};
+            if (state.storageBindings[b].buffer == buffers[i]) state.storageBindings[b] = (IndexedBinding) {0, 0, 0};
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void gls_deleteTextures(const GLsizei count, const GLuint textures[]) {
+    for (GLsizei i = 0; i < count; i++) {
+        for (size_t u = 0; u < GLS_TEXTURE_UNITS; u++) {
+            for (size_t t = 0; t < TEXTURE_TARGET_COUNT; t++) {
+                if (state.textures[u][t] == textures[i]) state.textures[u][t] = 0;
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
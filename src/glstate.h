@@ -0,0 +1,76 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "glad/glad.h"
+
+#define GLS_TEXTURE_UNITS 16
+/**
+ * Indexed uniform and shader storage buffer bindings that are shadowed, higher ones are always passed through.
+ */
+#define GLS_BUFFER_BINDINGS 16
+
+/**
+ * Calls made through the state cache since the last gls_resetStats, and how many of them were skipped because they
+ * would have changed nothing.
+ */
+typedef struct {
+    size_t calls, skipped;
+} GlStateStats;
+
+extern GlStateStats gls_stats;
+
+/**
+ * Forgets all shadowed state, so the next call of every kind reaches GL. Needed after state is changed around the
+ * cache, which is otherwise assumed to see every change of the state it shadows.
+ */
+void gls_invalidate();
+
+void gls_resetStats();
+
+void gls_useProgram(GLuint program);
+
+/**
+ * Binding a vertex array also forgets the shadowed element array buffer, which belongs to the vertex array.
+ */
+void gls_bindVertexArray(GLuint vertexArray);
+
+void gls_bindBuffer(GLenum target, GLuint buffer);
+
+/**
+ * glBindBufferBase, which binds the buffer to target as well.
+ */
+void gls_bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+void gls_bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+/**
+ * Binds texture to target on a texture unit, changing the active unit only when the binding changes.
+ */
+void gls_bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+void gls_bindSampler(GLuint unit, GLuint sampler);
+
+void gls_setBlend(bool isEnabled);
+
+void gls_blendFunc(GLenum source, GLenum destination);
+
+void gls_setDepthTest(bool isEnabled);
+
+void gls_depthFunc(GLenum func);
+
+void gls_depthMask(bool isWritten);
+
+void gls_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+/**
+ * Deleting objects through the cache keeps it from skipping binds of new objects that reuse their names.
+ */
+void gls_deleteVertexArrays(GLsizei count, const GLuint vertexArrays[]);
+
+void gls_deleteBuffers(GLsizei count, const GLuint buffers[]);
+
+void gls_deleteTextures(GLsizei count, const GLuint textures[]);
+
+#endif //GLSTATE_H
@@ -0,0 +1,83 @@
+#include "gpucull.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "glstate.h"
+
+static GLuint createBuffer(const GLenum target, const size_t size, const GLenum usage) {
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    gls_bindBuffer(target, buffer);
+    glBufferData(target, (GLsizeiptr) size, NULL, usage);
+    return buffer;
+}
+
+GpuCull *gpucull_allocate(const BatchRenderer *const batch, ComputeProgram *const program,
+                          const size_t objectCapacity) {
+    GpuCull *c = malloc(sizeof(GpuCull));
+    c->batch = batch;
+    c->program = program;
+    c->objectCount = 0;
+    c->objectCapacity = objectCapacity;
+
+    c->uniformBuffer = createBuffer(GL_UNIFORM_BUFFER, sizeof(GpuCullUniforms), GL_DYNAMIC_DRAW);
+    c->objectBuffer = createBuffer(GL_SHADER_STORAGE_BUFFER, objectCapacity * sizeof(GpuCullObject), GL_STATIC_DRAW);
+    c->commandBuffer = createBuffer(GL_DRAW_INDIRECT_BUFFER, objectCapacity * sizeof(DrawElementsIndirectCommand),
+                                    GL_DYNAMIC_COPY);
+    c->countBuffer = createBuffer(GL_PARAMETER_BUFFER, sizeof(GLuint), GL_DYNAMIC_COPY);
+    // The mesh ranges match the std430 struct {uint firstIndex; uint indexCount; int baseVertex;}
+    c->meshBuffer = createBuffer(GL_SHADER_STORAGE_BUFFER, batch->meshCount * sizeof(BatchMesh), GL_STATIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr) (batch->meshCount * sizeof(BatchMesh)), batch->meshes);
+    return c;
+}
+
+void gpucull_dispose(GpuCull *c) {
+    const GLuint buffers[] = {c->uniformBuffer, c->objectBuffer, c->meshBuffer, c->commandBuffer, c->countBuffer};
+    gls_deleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers);
+    comp_dispose(c->program);
+    free(c);
+}
+
+void gpucull_setObjects(GpuCull *const c, const GpuCullObject objects[], const size_t first, const size_t count) {
+    gls_bindBuffer(GL_SHADER_STORAGE_BUFFER, c->objectBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, (GLintptr) (first * sizeof(GpuCullObject)),
+                    (GLsizeiptr) (count * sizeof(GpuCullObject)), objects);
+    if (first + count > c->objectCount) c->objectCount = first + count;
+}
+
+void gpucull_cull(const GpuCull *const c, const Camera *const camera) {
+    GpuCullUniforms uniforms;
+    memcpy(uniforms.planes, camera->frustum->planes, sizeof(uniforms.planes));
+    uniforms.objectCount = (uint32_t) c->objectCount;
+    gls_bindBuffer(GL_UNIFORM_BUFFER, c->uniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GpuCullUniforms), &uniforms);
+
+    const GLuint zero = 0;
+    gls_bindBuffer(GL_PARAMETER_BUFFER, c->countBuffer);
+    glBufferSubData(GL_PARAMETER_BUFFER, 0, sizeof(GLuint), &zero);
+
+    comp_bindUniforms(GPUCULL_UNIFORM_BINDING, c->uniformBuffer);
+    comp_bindStorage(GPUCULL_OBJECT_BINDING, c->objectBuffer);
+    comp_bindStorage(GPUCULL_MESH_BINDING, c->meshBuffer);
+    comp_bindStorage(GPUCULL_COMMAND_BINDING, c->commandBuffer);
+    comp_bindStorage(GPUCULL_COUNT_BINDING, c->countBuffer);
+
+    comp_dispatchInvocations(c->program, c->objectCount, 1, 1);
+    // The commands and their count are read as indirect arguments, the objects as storage by the vertex shader
+    comp_barrier(COMP_BARRIER_COMMANDS | COMP_BARRIER_STORAGE);
+}
+
+void gpucull_draw(const GpuCull *const c) {
+    gls_bindVertexArray(c->batch->megabuffer->vao);
+    gls_bindBuffer(GL_DRAW_INDIRECT_BUFFER, c->commandBuffer);
+    gls_bindBuffer(GL_PARAMETER_BUFFER, c->countBuffer);
+    glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, 0, (GLsizei) c->objectCount, 0);
+}
+
+GLuint gpucull_readVisibleCount(const GpuCull *const c) {
+    GLuint count;
+    gls_bindBuffer(GL_PARAMETER_BUFFER, c->countBuffer);
+    glGetBufferSubData(GL_PARAMETER_BUFFER, 0, sizeof(GLuint), &count);
+    return count;
+}
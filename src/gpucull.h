@@ -0,0 +1,88 @@
+#ifndef GPUCULL_H
+#define GPUCULL_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "batch.h"
+#include "camera.h"
+#include "compute.h"
+#include "glad/glad.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+
+/**
+ * Uniform block binding of GpuCullUniforms.
+ */
+#define GPUCULL_UNIFORM_BINDING 0
+/**
+ * Shader storage bindings of the objects, the mesh ranges, the written commands and their count.
+ */
+#define GPUCULL_OBJECT_BINDING 1
+#define GPUCULL_MESH_BINDING 2
+#define GPUCULL_COMMAND_BINDING 3
+#define GPUCULL_COUNT_BINDING 4
+
+/**
+ * Per-object data, laid out as the std430 struct {mat4 model; vec4 sphere; vec4 color; uint mesh;}. The sphere is
+ * the world-space bounding sphere, center in xyz and radius in w.
+ */
+typedef struct {
+    float model[4][4];
+    Vector4f sphere;
+    Vector4f color;
+    uint32_t mesh;
+    uint32_t _pad[3];
+} GpuCullObject;
+
+/**
+ * Per-frame data, laid out as the std140 block {vec4 planes[6]; uint objectCount;}. The shaders drawing the output
+ * read the camera from the Camera block.
+ */
+typedef struct {
+    Vector4f planes[6];
+    uint32_t objectCount;
+    uint32_t _pad[3];
+} GpuCullUniforms;
+
+/**
+ * Culls objects against the camera's frustum in a compute shader that appends a command for every visible object,
+ * then draws the commands with glMultiDrawElementsIndirectCount. The CPU only uploads the camera and resets the
+ * count each frame, whatever the number of objects. The meshes come from the megabuffer of a built BatchRenderer;
+ * each command's base instance is the index of its object, which shaders read as gl_BaseInstance. Needs OpenGL 4.6.
+ */
+typedef struct {
+    const BatchRenderer *batch;
+    ComputeProgram *program;
+    GLuint uniformBuffer, objectBuffer, meshBuffer, commandBuffer, countBuffer;
+    size_t objectCount, objectCapacity;
+} GpuCull;
+
+/**
+ * Takes ownership of program, the loaded cull.comp.
+ */
+GpuCull *gpucull_allocate(const BatchRenderer *batch, ComputeProgram *program, size_t objectCapacity);
+
+void gpucull_dispose(GpuCull *c);
+
+/**
+ * Uploads count objects starting at first, growing the object count to cover them. first + count must not exceed
+ * the capacity.
+ */
+void gpucull_setObjects(GpuCull *c, const GpuCullObject objects[], size_t first, size_t count);
+
+/**
+ * Runs the culling pass for the camera, whose matrices must be up to date.
+ */
+void gpucull_cull(const GpuCull *c, const Camera *camera);
+
+/**
+ * Draws the commands written by the last gpucull_cull. The program reading the objects must be in use.
+ */
+void gpucull_draw(const GpuCull *c);
+
+/**
+ * Reads the number of visible objects back. Waits for the culling pass to finish, so it is meant for reports only.
+ */
+GLuint gpucull_readVisibleCount(const GpuCull *c);
+
+#endif //GPUCULL_H
@@ -1,5 +1,4 @@
 #include <dirent.h>
-#include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -15,10 +14,6 @@ static char **shaderFilenames;
 
 void setShaderInfoFromArguments(int argc, char **argv);
 
-static char *getShaderSource(WindowData *win, const char *filename);
-
-static GLenum getShaderType(const char *filename);
-
 void setupShaderCompiling(WindowData *win);
 
 static void disposeShaders();
@@ -42,6 +37,14 @@ int main(const int argc, char **argv) {
 
     llog(INFO, "Initializing window");
     WindowData *win = win_init(1000, 700, "Hiya, OpenGL!");
+    // An optional argument after the shader filenames picks the scene
+    if ((size_t) argc > 3 + shaderCount) {
+        const char *const scene = argv[3 + shaderCount];
+        if (strcmp(scene, "stress") == 0) win->scene = WIN_SCENE_STRESS;
+        if (strcmp(scene, "batch") == 0) win->scene = WIN_SCENE_BATCH;
+        if (strcmp(scene, "gpucull") == 0) win->scene = WIN_SCENE_GPU_CULL;
+        if (strcmp(scene, "queue") == 0) win->scene = WIN_SCENE_QUEUE;
+    }
 
     llog(INFO, "Starting compiling shaders");
     setupShaderCompiling(win);
@@ -79,59 +82,11 @@ void setShaderInfoFromArguments(const int argc, char **argv) {
     }
 }
 
-static char *getShaderSource(WindowData *const win, const char *const filename) {
-    const unsigned pathLength = strlen(resourceDirectory) + strlen(shaderDirectory) + strlen(filename) + 1;
-    char path[pathLength];
-    snprintf(path, pathLength, "%s%s%s", resourceDirectory, shaderDirectory, filename);
-
-    FILE *file = fopen(path, "r");
-    if (file == NULL) {
-        llog(ERROR, "Failed to open a shader source. %s: %s", strerror(errno), path);
-        win_disposeAndAbort(win);
-    }
-
-    fseek(file, 0, SEEK_END);
-    const int size = (int) ftell(file);
-    fseek(file, 0, SEEK_SET);
-    char *source = malloc((size + 1) * sizeof(char));
-
-    fread(source, sizeof(char), size, file);
-    source[size] = '\0';
-
-    fclose(file);
-    return source;
-}
-
-static GLenum getShaderType(const char *const filename) {
-    char temp[strlen(filename) + 1];
-    strcpy(temp, filename);
-    strtok(temp, ".");
-    const char *const token = strtok(NULL, ".");
-    if (token != NULL) {
-        if (strcmp(token, "vert") == 0) {
-            return GL_VERTEX_SHADER;
-        }
-        if (strcmp(token, "frag") == 0) {
-            return GL_FRAGMENT_SHADER;
-        }
-        if (strcmp(token, "geom") == 0) {
-            return GL_GEOMETRY_SHADER;
-        }
-        if (strcmp(token, "tesc") == 0) {
-            return GL_TESS_CONTROL_SHADER;
-        }
-        if (strcmp(token, "tese") == 0) {
-            return GL_TESS_EVALUATION_SHADER;
-        }
-    }
-    return GL_NONE;
-}
-
 void setupShaderCompiling(WindowData *const win) {
     shaders = malloc(shaderCount * sizeof(Shader));
     for (int i = 0; i < shaderCount; i++) {
         char *const filename = shaderFilenames[i];
-        const GLenum type = getShaderType(filename);
+        const GLenum type = shader_getType(filename);
 
         llog(INFO, "Getting shader source: %s", filename);
 
@@ -139,7 +94,13 @@ void setupShaderCompiling(WindowData *const win) {
             llog(ERROR, "Unknown shader type for %s", filename);
             win_disposeAndAbort(win);
         }
-        const Shader shader = {filename, getShaderSource(win, filename), type};
+        if (type == GL_COMPUTE_SHADER) {
+            llog(ERROR, "Compute shaders cannot link into the window's program: %s", filename);
+            win_disposeAndAbort(win);
+        }
+        const char *const source = shader_readSource(filename);
+        if (source == NULL) win_disposeAndAbort(win);
+        const Shader shader = {filename, source, type};
         shaders[i] = shader;
     }
 }
@@ -0,0 +1,139 @@
+#include "culling.h"
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void cull_extractFrustum(const Matrix4f *const vp, Frustum *const res) {
+    // Gribb-Hartmann: each clip inequality is the last row of vp plus or minus one of the others
+    const float (*const t)[4] = vp->t;
+    for (int i = 0; i < CULL_PLANE_COUNT; i++) {
+        const int row = i / 2;
+        const float sign = i % 2 == 0 ? 1.0f : -1.0f;
+        Vector4f plane = {
+            t[0][3] + sign * t[0][row],
+            t[1][3] + sign * t[1][row],
+            t[2][3] + sign * t[2][row],
+            t[3][3] + sign * t[3][row],
+        };
+        const float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) vec_multNum4f(&plane, 1.0f / length, &plane);
+        res->planes[i] = plane;
+    }
+}
+
+bool cull_testSphere(const Frustum *const f, const Vector3f *const center, const float radius) {
+    for (int i = 0; i < CULL_PLANE_COUNT; i++) {
+        const Vector4f *const p = f->planes + i;
+        if (p->x * center->x + p->y * center->y + p->z * center->z + p->w < -radius) return false;
+    }
+    return true;
+}
+
+bool cull_testAabb(const Frustum *const f, const Vector3f *const center, const Vector3f *const extent) {
+    for (int i = 0; i < CULL_PLANE_COUNT; i++) {
+        const Vector4f *const p = f->planes + i;
+        const float distance = p->x * center->x + p->y * center->y + p->z * center->z + p->w;
+        const float radius = fabsf(p->x) * extent->x + fabsf(p->y) * extent->y + fabsf(p->z) * extent->z;
+        if (distance < -radius) return false;
+    }
+    return true;
+}
+
+/**
+ * Appends the indices of the set bits of a four-lane mask without branching on them. visible always gets
+ * four writes, so it needs room for them even when only some are kept.
+ */
+static size_t appendVisible(uint32_t visible[], size_t visibleCount, const uint32_t first, const int mask) {
+    for (uint32_t lane = 0; lane < 4; lane++) {
+        visible[visibleCount] = first + lane;
+        visibleCount += (size_t) (mask >> lane) & 1;
+    }
+    return visibleCount;
+}
+
+size_t cull_spheres(const Frustum *const f, const float x[], const float y[], const float z[],
+                    const float radius[], const size_t count, uint32_t visible[]) {
+    size_t visibleCount = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128 planeX[CULL_PLANE_COUNT], planeY[CULL_PLANE_COUNT], planeZ[CULL_PLANE_COUNT], planeW[CULL_PLANE_COUNT];
+    for (int p = 0; p < CULL_PLANE_COUNT; p++) {
+        planeX[p] = _mm_set1_ps(f->planes[p].x);
+        planeY[p] = _mm_set1_ps(f->planes[p].y);
+        planeZ[p] = _mm_set1_ps(f->planes[p].z);
+        planeW[p] = _mm_set1_ps(f->planes[p].w);
+    }
+    // visibleCount never exceeds i, so the four writes of appendVisible stay below i + 4 <= count
+    for (; i + 4 <= count; i += 4) {
+        const __m128 sx = _mm_loadu_ps(x + i);
+        const __m128 sy = _mm_loadu_ps(y + i);
+        const __m128 sz = _mm_loadu_ps(z + i);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+        __m128 isInside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < CULL_PLANE_COUNT; p++) {
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planeX[p], sx), _mm_mul_ps(planeY[p], sy)),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], sz), planeW[p])
+            );
+            isInside = _mm_and_ps(isInside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        visibleCount = appendVisible(visible, visibleCount, (uint32_t) i, _mm_movemask_ps(isInside));
+    }
+#endif
+    for (; i < count; i++) {
+        const Vector3f center = {x[i], y[i], z[i]};
+        if (cull_testSphere(f, &center, radius[i])) visible[visibleCount++] = (uint32_t) i;
+    }
+    return visibleCount;
+}
+
+size_t cull_aabbs(const Frustum *const f, const float centerX[], const float centerY[], const float centerZ[],
+                  const float extentX[], const float extentY[], const float extentZ[], const size_t count,
+                  uint32_t visible[]) {
+    size_t visibleCount = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128 planeX[CULL_PLANE_COUNT], planeY[CULL_PLANE_COUNT], planeZ[CULL_PLANE_COUNT], planeW[CULL_PLANE_COUNT];
+    __m128 absX[CULL_PLANE_COUNT], absY[CULL_PLANE_COUNT], absZ[CULL_PLANE_COUNT];
+    for (int p = 0; p < CULL_PLANE_COUNT; p++) {
+        planeX[p] = _mm_set1_ps(f->planes[p].x);
+        planeY[p] = _mm_set1_ps(f->planes[p].y);
+        planeZ[p] = _mm_set1_ps(f->planes[p].z);
+        planeW[p] = _mm_set1_ps(f->planes[p].w);
+        absX[p] = _mm_set1_ps(fabsf(f->planes[p].x));
+        absY[p] = _mm_set1_ps(fabsf(f->planes[p].y));
+        absZ[p] = _mm_set1_ps(fabsf(f->planes[p].z));
+    }
+    for (; i + 4 <= count; i += 4) {
+        const __m128 cx = _mm_loadu_ps(centerX + i);
+        const __m128 cy = _mm_loadu_ps(centerY + i);
+        const __m128 cz = _mm_loadu_ps(centerZ + i);
+        const __m128 ex = _mm_loadu_ps(extentX + i);
+        const __m128 ey = _mm_loadu_ps(extentY + i);
+        const __m128 ez = _mm_loadu_ps(extentZ + i);
+        __m128 isInside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < CULL_PLANE_COUNT; p++) {
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p])
+            );
+            // Projected half size of the box onto the plane normal
+            const __m128 radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(absX[p], ex), _mm_mul_ps(absY[p], ey)),
+                _mm_mul_ps(absZ[p], ez)
+            );
+            isInside = _mm_and_ps(isInside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        visibleCount = appendVisible(visible, visibleCount, (uint32_t) i, _mm_movemask_ps(isInside));
+    }
+#endif
+    for (; i < count; i++) {
+        const Vector3f center = {centerX[i], centerY[i], centerZ[i]};
+        const Vector3f extent = {extentX[i], extentY[i], extentZ[i]};
+        if (cull_testAabb(f, &center, &extent)) visible[visibleCount++] = (uint32_t) i;
+    }
+    return visibleCount;
+}
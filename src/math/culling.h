@@ -0,0 +1,54 @@
+#ifndef CULLING_H
+#define CULLING_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+#include "vector.h"
+
+typedef enum {
+    CULL_PLANE_LEFT,
+    CULL_PLANE_RIGHT,
+    CULL_PLANE_BOTTOM,
+    CULL_PLANE_TOP,
+    CULL_PLANE_NEAR,
+    CULL_PLANE_FAR,
+    CULL_PLANE_COUNT
+} CullPlane;
+
+/**
+ * Six world-space planes (x, y, z) . p + w >= 0 bounding the visible volume, with unit normals pointing inside.
+ */
+typedef struct {
+    Vector4f planes[CULL_PLANE_COUNT];
+} Frustum;
+
+/**
+ * Extracts the frustum of a view-projection matrix using OpenGL's clip volume, -w <= x, y, z <= w.
+ */
+void cull_extractFrustum(const Matrix4f *vp, Frustum *res);
+
+bool cull_testSphere(const Frustum *f, const Vector3f *center, float radius);
+
+/**
+ * Tests an axis-aligned box given by its center and its half extent along each axis.
+ */
+bool cull_testAabb(const Frustum *f, const Vector3f *center, const Vector3f *extent);
+
+/**
+ * Tests count spheres stored as separate arrays and writes the indices of the visible ones to visible in increasing
+ * order. visible must have room for count indices; the number of visible spheres is returned.
+ * The tests are conservative: a sphere near a frustum corner may be reported visible while being outside.
+ */
+size_t cull_spheres(const Frustum *f, const float x[], const float y[], const float z[], const float radius[],
+                    size_t count, uint32_t visible[]);
+
+/**
+ * cull_spheres for axis-aligned boxes given by centers and half extents.
+ */
+size_t cull_aabbs(const Frustum *f, const float centerX[], const float centerY[], const float centerZ[],
+                  const float extentX[], const float extentY[], const float extentZ[], size_t count,
+                  uint32_t visible[]);
+
+#endif //CULLING_H
@@ -0,0 +1,128 @@
+#include "fastmath.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "fastmath_kernels.h"
+#include "../utility/cpu.h"
+
+static FmMode mode = FM_PRECISE;
+static const FastMathKernels *kernels = &fm_scalarKernels;
+
+__attribute__ ((constructor))
+static void selectKernels() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu_hasFeature(CPU_AVX)) {
+        kernels = &fm_avxKernels;
+    } else if (cpu_hasFeature(CPU_SSE2)) {
+        kernels = &fm_sse2Kernels;
+    }
+#endif
+}
+
+void fm_setMode(const FmMode newMode) {
+    mode = newMode;
+}
+
+FmMode fm_getMode() {
+    return mode;
+}
+
+void fm_sincosFast(const float x, float *const sinRes, float *const cosRes) {
+    const float absX = fabsf(x);
+    if (!(absX <= FM_MAX_ANGLE)) {
+        *sinRes = sinf(x);
+        *cosRes = cosf(x);
+        return;
+    }
+    // Nearest even multiple of pi/4, so the reduced angle lies in [-pi/4, pi/4]
+    const int j = ((int) (absX * FM_FOUR_OVER_PI) + 1) & ~1;
+    const float y = (float) j;
+    const float r = ((absX - y * FM_PI_4_PART1) - y * FM_PI_4_PART2) - y * FM_PI_4_PART3;
+    const float z = r * r;
+    const float sinPoly = r + r * z * (FM_SIN_S0 + z * (FM_SIN_S1 + z * FM_SIN_S2));
+    const float cosPoly = 1.0f - 0.5f * z + z * z * (FM_COS_C0 + z * (FM_COS_C1 + z * FM_COS_C2));
+
+    const int octant = j & 7;
+    const bool isSwapped = octant & 2;
+    float s = isSwapped ? cosPoly : sinPoly;
+    float c = isSwapped ? sinPoly : cosPoly;
+    if ((octant >= 4) != (x < 0.0f)) s = -s;
+    if (octant == 2 || octant == 4) c = -c;
+    *sinRes = s;
+    *cosRes = c;
+}
+
+static void sincosScalar(const float *const x, float *const sinRes, float *const cosRes, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float s, c;
+        fm_sincosFast(x[i], &s, &c);
+        if (sinRes != NULL) sinRes[i] = s;
+        if (cosRes != NULL) cosRes[i] = c;
+    }
+}
+
+static void tanScalar(const float *const x, float *const res, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float s, c;
+        fm_sincosFast(x[i], &s, &c);
+        res[i] = s / c;
+    }
+}
+
+const FastMathKernels fm_scalarKernels = {
+    sincosScalar,
+    tanScalar,
+};
+
+float fm_sinf(const float x) {
+    if (mode == FM_PRECISE) return sinf(x);
+    float s, c;
+    fm_sincosFast(x, &s, &c);
+    return s;
+}
+
+float fm_cosf(const float x) {
+    if (mode == FM_PRECISE) return cosf(x);
+    float s, c;
+    fm_sincosFast(x, &s, &c);
+    return c;
+}
+
+float fm_tanf(const float x) {
+    if (mode == FM_PRECISE) return tanf(x);
+    float s, c;
+    fm_sincosFast(x, &s, &c);
+    return s / c;
+}
+
+void fm_sincosf(const float x, float *const sinRes, float *const cosRes) {
+    if (mode == FM_PRECISE) {
+        *sinRes = sinf(x);
+        *cosRes = cosf(x);
+        return;
+    }
+    fm_sincosFast(x, sinRes, cosRes);
+}
+
+void fm_sincosArray(const float *const x, float *const sinRes, float *const cosRes, const size_t count) {
+    if (mode == FM_FAST) {
+        kernels->sincos(x, sinRes, cosRes, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const float angle = x[i];
+        if (sinRes != NULL) sinRes[i] = sinf(angle);
+        if (cosRes != NULL) cosRes[i] = cosf(angle);
+    }
+}
+
+void fm_tanArray(const float *const x, float *const res, const size_t count) {
+    if (mode == FM_FAST) {
+        kernels->tan(x, res, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        res[i] = tanf(x[i]);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+#include <stddef.h>
+
+/**
+ * FM_PRECISE forwards to libm. FM_FAST evaluates minimax polynomials after a three-part Cody-Waite reduction
+ * by pi/4, vectorized for the array functions. Measured against double precision, the fast mode is within
+ * 2 ULP for sin and cos and 4 ULP for tan (away from its poles) for |x| <= 100. Up to |x| <= 8192 the absolute
+ * error of sin and cos stays below 2^-23, but the relative error near their zeros grows. Larger angles,
+ * infinities and NaN fall back to libm.
+ */
+typedef enum {
+    FM_PRECISE,
+    FM_FAST,
+} FmMode;
+
+void fm_setMode(FmMode mode);
+
+FmMode fm_getMode();
+
+float fm_sinf(float x);
+
+float fm_cosf(float x);
+
+float fm_tanf(float x);
+
+void fm_sincosf(float x, float *sinRes, float *cosRes);
+
+/**
+ * Computes sin and cos of count angles. Either output may be NULL when it is not needed.
+ */
+void fm_sincosArray(const float *x, float *sinRes, float *cosRes, size_t count);
+
+void fm_tanArray(const float *x, float *res, size_t count);
+
+#endif //FASTMATH_H
@@ -0,0 +1,24 @@
+#include <immintrin.h>
+
+#define VEC __m256
+#define VEC_WIDTH 8
+#define V_SET1 _mm256_set1_ps
+#define V_LOADU _mm256_loadu_ps
+#define V_STOREU _mm256_storeu_ps
+#define V_ADD _mm256_add_ps
+#define V_SUB _mm256_sub_ps
+#define V_MUL _mm256_mul_ps
+#define V_DIV _mm256_div_ps
+#define V_AND _mm256_and_ps
+#define V_ANDNOT _mm256_andnot_ps
+#define V_OR _mm256_or_ps
+#define V_XOR _mm256_xor_ps
+#define V_CMPEQ(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#define V_CMPGE(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define V_CMPLE(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define V_CMPNLE(a, b) _mm256_cmp_ps(a, b, _CMP_NLE_UQ)
+#define V_TRUNC(v) _mm256_cvtepi32_ps(_mm256_cvttps_epi32(v))
+#define V_MOVEMASK _mm256_movemask_ps
+#define FASTMATH_KERNELS fm_avxKernels
+
+#include "fastmath_simd.h"
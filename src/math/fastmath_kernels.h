@@ -0,0 +1,42 @@
+#ifndef FASTMATH_KERNELS_H
+#define FASTMATH_KERNELS_H
+
+#include "fastmath.h"
+
+/*
+ * Constants of the fast path. Angles are reduced by multiples of pi/4 split into three parts of decreasing
+ * magnitude, so that most of the cancellation happens in products that are exact or nearly so.
+ */
+#define FM_FOUR_OVER_PI 1.27323954473516f
+#define FM_PI_4_PART1 0.78515625f
+#define FM_PI_4_PART2 2.4187564849853515625e-4f
+#define FM_PI_4_PART3 3.77489497744594108e-8f
+// Larger angles, infinities and NaN are passed on to libm
+#define FM_MAX_ANGLE 8192.0f
+
+// Minimax coefficients of sin(r) = r + r^3 (S0 + S1 r^2 + S2 r^4) and cos(r) = 1 - r^2 / 2 + r^4 (C0 + C1 r^2 + C2 r^4)
+#define FM_SIN_S0 -1.6666654611e-1f
+#define FM_SIN_S1 8.3321608736e-3f
+#define FM_SIN_S2 -1.9515295891e-4f
+#define FM_COS_C0 4.166664568298827e-2f
+#define FM_COS_C1 -1.388731625493765e-3f
+#define FM_COS_C2 2.443315711809948e-5f
+
+/**
+ * Fast mode implementation of the array functions for one instruction set.
+ */
+typedef struct {
+    void (*sincos)(const float *x, float *sinRes, float *cosRes, size_t count);
+    void (*tan)(const float *x, float *res, size_t count);
+} FastMathKernels;
+
+extern const FastMathKernels fm_scalarKernels;
+#if defined(__x86_64__) || defined(__i386__)
+extern const FastMathKernels fm_sse2Kernels;
+extern const FastMathKernels fm_avxKernels;
+#endif
+
+// Scalar fast path, used by the vector backends for the elements that do not fill a whole register
+void fm_sincosFast(float x, float *sinRes, float *cosRes);
+
+#endif //FASTMATH_KERNELS_H
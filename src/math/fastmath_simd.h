@@ -0,0 +1,114 @@
+#ifndef FASTMATH_SIMD_H
+#define FASTMATH_SIMD_H
+
+/*
+ * Vector fast path shared by fastmath_sse2.c and fastmath_avx.c. The including file maps the V_* operations
+ * onto one register width and names the resulting table with FASTMATH_KERNELS. Octant bookkeeping stays in
+ * float registers so that AVX without AVX2 needs no 256-bit integer instructions.
+ */
+
+#include <stddef.h>
+
+#include "fastmath_kernels.h"
+
+static VEC blend(const VEC mask, const VEC ifSet, const VEC ifClear) {
+    return V_OR(V_AND(mask, ifSet), V_ANDNOT(mask, ifClear));
+}
+
+static void sincosVec(const VEC x, VEC *const sinRes, VEC *const cosRes) {
+    const VEC signMask = V_SET1(-0.0f);
+    const VEC absX = V_ANDNOT(signMask, x);
+    // Truncation is floor here since the angle is non-negative; j is the nearest even multiple of pi/4
+    VEC j = V_TRUNC(V_MUL(absX, V_SET1(FM_FOUR_OVER_PI)));
+    j = V_MUL(V_TRUNC(V_MUL(V_ADD(j, V_SET1(1.0f)), V_SET1(0.5f))), V_SET1(2.0f));
+    const VEC octant = V_SUB(j, V_MUL(V_TRUNC(V_MUL(j, V_SET1(0.125f))), V_SET1(8.0f)));
+
+    VEC r = V_SUB(absX, V_MUL(j, V_SET1(FM_PI_4_PART1)));
+    r = V_SUB(r, V_MUL(j, V_SET1(FM_PI_4_PART2)));
+    r = V_SUB(r, V_MUL(j, V_SET1(FM_PI_4_PART3)));
+    const VEC z = V_MUL(r, r);
+
+    VEC sinPoly = V_ADD(V_SET1(FM_SIN_S1), V_MUL(z, V_SET1(FM_SIN_S2)));
+    sinPoly = V_ADD(V_SET1(FM_SIN_S0), V_MUL(z, sinPoly));
+    sinPoly = V_ADD(r, V_MUL(V_MUL(r, z), sinPoly));
+    VEC cosPoly = V_ADD(V_SET1(FM_COS_C1), V_MUL(z, V_SET1(FM_COS_C2)));
+    cosPoly = V_ADD(V_SET1(FM_COS_C0), V_MUL(z, cosPoly));
+    cosPoly = V_ADD(V_SUB(V_SET1(1.0f), V_MUL(V_SET1(0.5f), z)), V_MUL(V_MUL(z, z), cosPoly));
+
+    const VEC upperHalf = V_CMPGE(octant, V_SET1(4.0f));
+    const VEC isSwapped = V_CMPEQ(V_SUB(octant, V_AND(upperHalf, V_SET1(4.0f))), V_SET1(2.0f));
+    const VEC sinSign = V_XOR(V_AND(x, signMask), V_AND(upperHalf, signMask));
+    const VEC cosSign = V_AND(V_AND(V_CMPGE(octant, V_SET1(2.0f)), V_CMPLE(octant, V_SET1(4.0f))), signMask);
+    *sinRes = V_XOR(blend(isSwapped, cosPoly, sinPoly), sinSign);
+    *cosRes = V_XOR(blend(isSwapped, sinPoly, cosPoly), cosSign);
+}
+
+static int outOfRangeMask(const VEC x) {
+    return V_MOVEMASK(V_CMPNLE(V_ANDNOT(V_SET1(-0.0f), x), V_SET1(FM_MAX_ANGLE)));
+}
+
+static void sincosArray(const float *const x, float *const sinRes, float *const cosRes, const size_t count) {
+    size_t i = 0;
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        const VEC angles = V_LOADU(x + i);
+        const int outOfRange = outOfRangeMask(angles);
+        VEC s, c;
+        sincosVec(angles, &s, &c);
+        if (outOfRange) {
+            // The outputs may overwrite x, so the fallback works on a copy of the angles
+            float copy[VEC_WIDTH], sinLanes[VEC_WIDTH], cosLanes[VEC_WIDTH];
+            V_STOREU(copy, angles);
+            V_STOREU(sinLanes, s);
+            V_STOREU(cosLanes, c);
+            for (int lane = 0; lane < VEC_WIDTH; lane++) {
+                if (outOfRange & 1 << lane) fm_sincosFast(copy[lane], sinLanes + lane, cosLanes + lane);
+            }
+            s = V_LOADU(sinLanes);
+            c = V_LOADU(cosLanes);
+        }
+        if (sinRes != NULL) V_STOREU(sinRes + i, s);
+        if (cosRes != NULL) V_STOREU(cosRes + i, c);
+    }
+    for (; i < count; i++) {
+        float s, c;
+        fm_sincosFast(x[i], &s, &c);
+        if (sinRes != NULL) sinRes[i] = s;
+        if (cosRes != NULL) cosRes[i] = c;
+    }
+}
+
+static void tanArray(const float *const x, float *const res, const size_t count) {
+    size_t i = 0;
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        const VEC angles = V_LOADU(x + i);
+        const int outOfRange = outOfRangeMask(angles);
+        VEC s, c;
+        sincosVec(angles, &s, &c);
+        VEC t = V_DIV(s, c);
+        if (outOfRange) {
+            float copy[VEC_WIDTH], lanes[VEC_WIDTH];
+            V_STOREU(copy, angles);
+            V_STOREU(lanes, t);
+            for (int lane = 0; lane < VEC_WIDTH; lane++) {
+                if (!(outOfRange & 1 << lane)) continue;
+                float laneSin, laneCos;
+                fm_sincosFast(copy[lane], &laneSin, &laneCos);
+                lanes[lane] = laneSin / laneCos;
+            }
+            t = V_LOADU(lanes);
+        }
+        V_STOREU(res + i, t);
+    }
+    for (; i < count; i++) {
+        float s, c;
+        fm_sincosFast(x[i], &s, &c);
+        res[i] = s / c;
+    }
+}
+
+const FastMathKernels FASTMATH_KERNELS = {
+    sincosArray,
+    tanArray,
+};
+
+#endif //FASTMATH_SIMD_H
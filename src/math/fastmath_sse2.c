@@ -0,0 +1,24 @@
+#include <emmintrin.h>
+
+#define VEC __m128
+#define VEC_WIDTH 4
+#define V_SET1 _mm_set1_ps
+#define V_LOADU _mm_loadu_ps
+#define V_STOREU _mm_storeu_ps
+#define V_ADD _mm_add_ps
+#define V_SUB _mm_sub_ps
+#define V_MUL _mm_mul_ps
+#define V_DIV _mm_div_ps
+#define V_AND _mm_and_ps
+#define V_ANDNOT _mm_andnot_ps
+#define V_OR _mm_or_ps
+#define V_XOR _mm_xor_ps
+#define V_CMPEQ _mm_cmpeq_ps
+#define V_CMPGE _mm_cmpge_ps
+#define V_CMPLE _mm_cmple_ps
+#define V_CMPNLE _mm_cmpnle_ps
+#define V_TRUNC(v) _mm_cvtepi32_ps(_mm_cvttps_epi32(v))
+#define V_MOVEMASK _mm_movemask_ps
+#define FASTMATH_KERNELS fm_sse2Kernels
+
+#include "fastmath_simd.h"
@@ -0,0 +1,18 @@
+#ifndef MATHINLINE_H
+#define MATHINLINE_H
+
+/*
+ * With DUMMY3D_INLINE_MATH defined, the cheapest math functions become static inline definitions in their
+ * headers so render code can inline them without LTO. Inlined matrix functions use SSE2 directly instead of
+ * the backend picked by mat_setBackend. The files implementing the out-of-line versions define
+ * MATH_OUT_OF_LINE first, so the library exports them in either mode.
+ */
+
+#if defined(DUMMY3D_INLINE_MATH) && !defined(MATH_OUT_OF_LINE)
+#define MATH_INLINE
+#define MATH_API static inline
+#else
+#define MATH_API
+#endif
+
+#endif //MATHINLINE_H
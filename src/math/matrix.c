@@ -1,65 +1,144 @@
+#define MATH_OUT_OF_LINE
 #include "matrix.h"
 
-#include <math.h>
+#include <stddef.h>
+
+#include "fastmath.h"
+#include "matrix_kernels.h"
+#include "../utility/cpu.h"
+
+static const char *const backendNames[MAT_BACKEND_COUNT] = {"scalar", "sse2", "avx", "fma"};
+
+static MatBackend currentBackend = MAT_BACKEND_SCALAR;
+static const MatrixKernels *kernels = &mat_scalarKernels;
+
+static const MatrixKernels *getKernels(const MatBackend backend) {
+    switch (backend) {
+        case MAT_BACKEND_SCALAR:
+            return &mat_scalarKernels;
+#if defined(__x86_64__) || defined(__i386__)
+        case MAT_BACKEND_SSE2:
+            return cpu_hasFeature(CPU_SSE2) ? &mat_sse2Kernels : NULL;
+        case MAT_BACKEND_AVX:
+            return cpu_hasFeature(CPU_AVX) ? &mat_avxKernels : NULL;
+        case MAT_BACKEND_FMA:
+            return cpu_hasFeature(CPU_FMA) ? &mat_fmaKernels : NULL;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+__attribute__ ((constructor))
+static void selectBackend() {
+    for (int backend = MAT_BACKEND_COUNT - 1; backend >= 0; backend--) {
+        if (mat_setBackend(backend)) return;
+    }
+}
+
+bool mat_isBackendSupported(const MatBackend backend) {
+    return getKernels(backend) != NULL;
+}
+
+bool mat_setBackend(const MatBackend backend) {
+    const MatrixKernels *const k = getKernels(backend);
+    if (k == NULL) return false;
+    kernels = k;
+    currentBackend = backend;
+    return true;
+}
+
+MatBackend mat_getBackend() {
+    return currentBackend;
+}
+
+const char *mat_getBackendName(const MatBackend backend) {
+    return backend < MAT_BACKEND_COUNT ? backendNames[backend] : "unknown";
+}
 
 void mat_multVec4f(const Matrix4f *const m, const Vector4f *const v, Vector4f *const res) {
-    res->x = m->t[0][0] * v->x + m->t[1][0] * v->y + m->t[2][0] * v->z + m->t[3][0] * v->w;
-    res->y = m->t[0][1] * v->x + m->t[1][1] * v->y + m->t[2][1] * v->z + m->t[3][1] * v->w;
-    res->z = m->t[0][2] * v->x + m->t[1][2] * v->y + m->t[2][2] * v->z + m->t[3][2] * v->w;
-    res->w = m->t[0][3] * v->x + m->t[1][3] * v->y + m->t[2][3] * v->z + m->t[3][3] * v->w;
+    kernels->multVec4f(m, v, res);
+}
+
+void mat_multVec4fArray(const Matrix4f *const m, const Vector4f *const in, Vector4f *const out, const size_t count,
+                        const unsigned flags) {
+    kernels->multVec4fArray(m, in, out, count, flags);
+}
+
+void mat_multVec3fArray(const Matrix4f *const m, const Vector3f *const in, Vector3f *const out, const size_t count,
+                        const unsigned flags) {
+    kernels->multVec3fArray(m, in, out, count, flags);
+}
+
+void mat_multVec3fSoA(const Matrix4f *const m, const float *const x, const float *const y, const float *const z,
+                      float *const outX, float *const outY, float *const outZ, const size_t count,
+                      const unsigned flags) {
+    kernels->multVec3fSoA(m, x, y, z, outX, outY, outZ, count, flags);
 }
 
 void mat_multMat4f(const Matrix4f *const l, const Matrix4f *const r, Matrix4f *const res) {
-    for (int column = 0; column < 4; column++) {
-        for (int row = 0; row < 4; row++) {
-            float *const curr = res->t[column] + row;
-            for (int i = 0; i < 4; i++) {
-                *curr += l->t[i][row] * r->t[column][i];
-            }
-        }
-    }
+    kernels->multMat4f(l, r, res);
+}
+
+void mat_transpose(const Matrix4f *const m, Matrix4f *const res) {
+    kernels->transpose(m, res);
+}
+
+void mat_inverseRigid(const Matrix4f *const m, Matrix4f *const res) {
+    kernels->inverseRigidArray(m, res, 1);
+}
+
+bool mat_inverseAffine(const Matrix4f *const m, Matrix4f *const res) {
+    return kernels->inverseAffineArray(m, res, 1);
+}
+
+bool mat_inverse(const Matrix4f *const m, Matrix4f *const res) {
+    return kernels->inverseArray(m, res, 1);
+}
+
+void mat_inverseRigidArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    kernels->inverseRigidArray(in, out, count);
+}
+
+bool mat_inverseAffineArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    return kernels->inverseAffineArray(in, out, count);
+}
+
+bool mat_inverseArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    return kernels->inverseArray(in, out, count);
 }
 
 void mat_identity(Matrix4f *const res) {
-    res->t[0][0] = 1.0f;
-    res->t[1][1] = 1.0f;
-    res->t[2][2] = 1.0f;
-    res->t[3][3] = 1.0f;
+    kernels->identity(res);
 }
 
 void mat_translation(Matrix4f *const res, const Vector3f *const pos) {
-    mat_identity(res);
-    res->t[3][0] = pos->x;
-    res->t[3][1] = pos->y;
-    res->t[3][2] = pos->z;
+    kernels->translation(res, pos);
 }
 
 void mat_rotation(Matrix4f *const res, const Vector3f *const rot) {
-    const float xSin = sinf(rot->x);
-    const float xCos = cosf(rot->x);
-    const float ySin = sinf(rot->y);
-    const float yCos = cosf(rot->y);
-    const float zSin = sinf(rot->z);
-    const float zCos = cosf(rot->z);
-    res->t[0][0] = yCos * zCos;
-    res->t[0][1] = xSin * ySin * zCos - xCos * zSin;
-    res->t[0][2] = xCos * ySin * zCos + xSin * zSin;
-    res->t[1][0] = yCos * zSin;
-    res->t[1][1] = xSin * ySin * zSin + xCos * zCos;
-    res->t[1][2] = xCos * ySin * zSin - xSin * zCos;
-    res->t[2][0] = -ySin;
-    res->t[2][1] = xSin * yCos;
-    res->t[2][2] = xCos * yCos;
-    res->t[3][3] = 1.0f;
-}
-
-void mat_perspective(Matrix4f *const res, const float aspect, const float fov, const float near,
-                         const float far) {
-    const float fovFactor = 1.0f / tanf(fov / 2.0f);
-    const float zFactor = far / (far - near);
-    res->t[0][0] = aspect * fovFactor;
-    res->t[1][1] = fovFactor;
-    res->t[2][2] = zFactor;
-    res->t[2][3] = 1.0f;
-    res->t[3][2] = -zFactor * near;
+    kernels->rotation(res, rot);
+}
+
+void mat_rotationArray(Matrix4f *const res, const Vector3f *const rot, const size_t count) {
+    // Vector3f packs x, y and z back to back, so a chunk of rotations is one contiguous run of angles
+    enum { CHUNK = 64 };
+    float sines[CHUNK * 3], cosines[CHUNK * 3];
+    for (size_t first = 0; first < count; first += CHUNK) {
+        const size_t chunk = count - first < CHUNK ? count - first : CHUNK;
+        fm_sincosArray(&rot[first].x, sines, cosines, chunk * 3);
+        for (size_t i = 0; i < chunk; i++) {
+            const float *const s = sines + i * 3;
+            const float *const c = cosines + i * 3;
+            mat_rotationSinCos(res + first + i, s[0], c[0], s[1], c[1], s[2], c[2]);
+        }
+    }
+}
+
+void mat_rotationQuat(Matrix4f *const res, const Quatf *const q) {
+    kernels->rotationQuat(res, q);
+}
+
+void mat_perspective(Matrix4f *const res, const float aspect, const float fov, const float near, const float far) {
+    kernels->perspective(res, aspect, fov, near, far);
 }
@@ -1,26 +1,124 @@
 #ifndef MATRIX_H
 #define MATRIX_H
+#include <stdbool.h>
+#include <stddef.h>
 
+#include "mathinline.h"
+#include "quaternion.h"
 #include "vector.h"
 
+// The inline matrix bodies need SSE2; without it the out-of-line, dispatched versions are used
+#if defined(MATH_INLINE) && defined(__SSE2__)
+#define MATRIX_INLINE
+#define MATRIX_API static inline
+#else
+#define MATRIX_API
+#endif
+
 /**
  * Represents a 4x4 matrix of float values used for 3D transformations.
  * The matrix is stored in column-major order, where t[column][row].
+ * Aligned to 32 bytes so every column pair can be loaded with a single AVX load.
  */
 typedef struct {
-    float t[4][4];
+    _Alignas(32) float t[4][4];
 } Matrix4f;
 
-void mat_multVec4f(const Matrix4f *m, const Vector4f *v, Vector4f *res);
+/**
+ * Instruction sets the matrix functions can run on. The best one supported by the CPU is selected
+ * when the process starts.
+ */
+typedef enum {
+    MAT_BACKEND_SCALAR,
+    MAT_BACKEND_SSE2,
+    MAT_BACKEND_AVX,
+    MAT_BACKEND_FMA,
+    MAT_BACKEND_COUNT
+} MatBackend;
+
+bool mat_isBackendSupported(MatBackend backend);
+
+bool mat_setBackend(MatBackend backend);
+
+MatBackend mat_getBackend();
+
+const char *mat_getBackendName(MatBackend backend);
+
+/**
+ * Flags of the batched transforms. Vector3f inputs are treated as points (w = 1) unless
+ * MAT_TRANSFORM_DIRECTION is set (w = 0). MAT_TRANSFORM_DIVIDE applies the perspective divide to the result;
+ * Vector4f results then get w = 1.
+ */
+typedef enum {
+    MAT_TRANSFORM_POINT = 0,
+    MAT_TRANSFORM_DIRECTION = 1 << 0,
+    MAT_TRANSFORM_DIVIDE = 1 << 1,
+} MatTransformFlags;
+
+MATRIX_API void mat_multVec4f(const Matrix4f *m, const Vector4f *v, Vector4f *res);
+
+/**
+ * Transforms count vectors by m. out may be the same array as in, but must not partially overlap it.
+ */
+void mat_multVec4fArray(const Matrix4f *m, const Vector4f *in, Vector4f *out, size_t count, unsigned flags);
+
+void mat_multVec3fArray(const Matrix4f *m, const Vector3f *in, Vector3f *out, size_t count, unsigned flags);
+
+/**
+ * Structure-of-arrays variant of mat_multVec3fArray, reading and writing separate x, y and z streams.
+ */
+void mat_multVec3fSoA(const Matrix4f *m, const float *x, const float *y, const float *z,
+                      float *outX, float *outY, float *outZ, size_t count, unsigned flags);
+
+MATRIX_API void mat_multMat4f(const Matrix4f *l, const Matrix4f *r, Matrix4f *res);
+
+void mat_transpose(const Matrix4f *m, Matrix4f *res);
 
-void mat_multMat4f(const Matrix4f *l, const Matrix4f *r, Matrix4f *res);
+/**
+ * Inverts a rotation + translation matrix, such as a view matrix, by transposing its rotation part.
+ * The result is meaningless if m contains scale, shear or projection.
+ */
+void mat_inverseRigid(const Matrix4f *m, Matrix4f *res);
+
+/**
+ * Inverts a matrix whose bottom row is (0, 0, 0, 1). Returns false and leaves res untouched if m is singular.
+ */
+bool mat_inverseAffine(const Matrix4f *m, Matrix4f *res);
+
+/**
+ * Inverts any matrix, including projections. Returns false and leaves res untouched if m is singular.
+ */
+bool mat_inverse(const Matrix4f *m, Matrix4f *res);
+
+void mat_inverseRigidArray(const Matrix4f *in, Matrix4f *out, size_t count);
+
+/**
+ * Returns false if at least one of the matrices is singular; those results are left untouched.
+ */
+bool mat_inverseAffineArray(const Matrix4f *in, Matrix4f *out, size_t count);
+
+bool mat_inverseArray(const Matrix4f *in, Matrix4f *out, size_t count);
 
-void mat_identity(Matrix4f *res);
+MATRIX_API void mat_identity(Matrix4f *res);
 
-void mat_translation(Matrix4f *res, const Vector3f *pos);
+MATRIX_API void mat_translation(Matrix4f *res, const Vector3f *pos);
 
 void mat_rotation(Matrix4f *res, const Vector3f *rot);
 
+/**
+ * Builds count rotation matrices at once, evaluating all sines and cosines with fm_sincosArray.
+ */
+void mat_rotationArray(Matrix4f *res, const Vector3f *rot, size_t count);
+
+/**
+ * Builds a rotation matrix from a unit quaternion without any trigonometry.
+ */
+void mat_rotationQuat(Matrix4f *res, const Quatf *q);
+
 void mat_perspective(Matrix4f *res, float aspect, float fov, float near, float far);
 
+#ifdef MATRIX_INLINE
+#include "matrix_inline.h"
+#endif
+
 #endif //MATRIX_H
@@ -0,0 +1,5 @@
+#define MADD128(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#define MADD256(a, b, c) _mm256_add_ps(_mm256_mul_ps(a, b), c)
+#define MATRIX_AVX_KERNELS mat_avxKernels
+
+#include "matrix_avx.h"
@@ -0,0 +1,158 @@
+#ifndef MATRIX_AVX_H
+#define MATRIX_AVX_H
+
+/*
+ * AVX kernel bodies shared by matrix_avx.c and matrix_fma.c. The including file defines MADD256/MADD128
+ * as either a fused or a separate multiply-add and names the resulting table with MATRIX_AVX_KERNELS.
+ */
+
+#include <immintrin.h>
+
+#include "matrix_sse.h"
+
+#include "matrix_kernels.h"
+
+#define SPLAT128(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+// Broadcasts element i of each 128-bit lane, i.e. of each of the two loaded columns
+#define SPLAT256(v, i) _mm256_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+
+static void multVec4f(const Matrix4f *const m, const Vector4f *const v, Vector4f *const res) {
+    const __m128 in = _mm_loadu_ps(&v->x);
+    __m128 sum = _mm_mul_ps(_mm_load_ps(m->t[0]), SPLAT128(in, 0));
+    sum = MADD128(_mm_load_ps(m->t[1]), SPLAT128(in, 1), sum);
+    sum = MADD128(_mm_load_ps(m->t[2]), SPLAT128(in, 2), sum);
+    sum = MADD128(_mm_load_ps(m->t[3]), SPLAT128(in, 3), sum);
+    _mm_storeu_ps(&res->x, sum);
+}
+
+static void multVec4fArray(const Matrix4f *const m, const Vector4f *const in, Vector4f *const out, const size_t count,
+                           const unsigned flags) {
+    const __m256 c0 = _mm256_broadcast_ps((const __m128 *) m->t[0]);
+    const __m256 c1 = _mm256_broadcast_ps((const __m128 *) m->t[1]);
+    const __m256 c2 = _mm256_broadcast_ps((const __m128 *) m->t[2]);
+    const __m256 c3 = _mm256_broadcast_ps((const __m128 *) m->t[3]);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m256 v = _mm256_loadu_ps(&in[i].x);
+        __m256 sum = _mm256_mul_ps(c0, SPLAT256(v, 0));
+        sum = MADD256(c1, SPLAT256(v, 1), sum);
+        sum = MADD256(c2, SPLAT256(v, 2), sum);
+        sum = MADD256(c3, SPLAT256(v, 3), sum);
+        if (flags & MAT_TRANSFORM_DIVIDE) {
+            sum = _mm256_blend_ps(_mm256_div_ps(sum, SPLAT256(sum, 3)), _mm256_set1_ps(1.0f), 0x88);
+        }
+        _mm256_storeu_ps(&out[i].x, sum);
+    }
+    mat_multVec4fArrayScalar(m, in + i, out + i, count - i, flags);
+}
+
+typedef struct {
+    __m256 e[4][4];
+} Broadcast4f;
+
+static Broadcast4f broadcastMatrix(const Matrix4f *const m, const unsigned flags) {
+    const float w = flags & MAT_TRANSFORM_DIRECTION ? 0.0f : 1.0f;
+    Broadcast4f b;
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 4; row++) b.e[column][row] = _mm256_set1_ps(m->t[column][row]);
+    }
+    for (int row = 0; row < 4; row++) b.e[3][row] = _mm256_set1_ps(m->t[3][row] * w);
+    return b;
+}
+
+static void transform8(const Broadcast4f *const b, const unsigned flags, __m256 *const x, __m256 *const y,
+                       __m256 *const z) {
+    __m256 res[4];
+    for (int row = 0; row < 4; row++) {
+        __m256 sum = MADD256(b->e[0][row], *x, b->e[3][row]);
+        sum = MADD256(b->e[1][row], *y, sum);
+        res[row] = MADD256(b->e[2][row], *z, sum);
+    }
+    if (flags & MAT_TRANSFORM_DIVIDE) {
+        for (int row = 0; row < 3; row++) res[row] = _mm256_div_ps(res[row], res[3]);
+    }
+    *x = res[0];
+    *y = res[1];
+    *z = res[2];
+}
+
+static void multVec3fArray(const Matrix4f *const m, const Vector3f *const in, Vector3f *const out, const size_t count,
+                           const unsigned flags) {
+    const Broadcast4f b = broadcastMatrix(m, flags);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // 8 packed vectors are 6 quarters of xyz; pair quarters n and n + 3 and shuffle them into x, y and z streams
+        const float *const src = &in[i].x;
+        const __m256 m03 = _mm256_loadu2_m128(src + 12, src);
+        const __m256 m14 = _mm256_loadu2_m128(src + 16, src + 4);
+        const __m256 m25 = _mm256_loadu2_m128(src + 20, src + 8);
+        const __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+        const __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+        __m256 x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        __m256 y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+
+        transform8(&b, flags, &x, &y, &z);
+
+        const __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+        float *const dst = &out[i].x;
+        _mm256_storeu2_m128(dst + 12, dst, r03);
+        _mm256_storeu2_m128(dst + 16, dst + 4, r14);
+        _mm256_storeu2_m128(dst + 20, dst + 8, r25);
+    }
+    mat_multVec3fArrayScalar(m, in + i, out + i, count - i, flags);
+}
+
+static void multVec3fSoA(const Matrix4f *const m, const float *const x, const float *const y, const float *const z,
+                         float *const outX, float *const outY, float *const outZ, const size_t count,
+                         const unsigned flags) {
+    const Broadcast4f b = broadcastMatrix(m, flags);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+        transform8(&b, flags, &vx, &vy, &vz);
+        _mm256_storeu_ps(outX + i, vx);
+        _mm256_storeu_ps(outY + i, vy);
+        _mm256_storeu_ps(outZ + i, vz);
+    }
+    mat_multVec3fSoAScalar(m, x + i, y + i, z + i, outX + i, outY + i, outZ + i, count - i, flags);
+}
+
+static void identity(Matrix4f *const res) {
+    _mm256_store_ps(res->t[0], _mm256_setr_ps(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f));
+    _mm256_store_ps(res->t[2], _mm256_setr_ps(0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+static void translation(Matrix4f *const res, const Vector3f *const pos) {
+    _mm256_store_ps(res->t[0], _mm256_setr_ps(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f));
+    _mm256_store_ps(res->t[2], _mm256_setr_ps(0.0f, 0.0f, 1.0f, 0.0f, pos->x, pos->y, pos->z, 1.0f));
+}
+
+const MatrixKernels MATRIX_AVX_KERNELS = {
+    multVec4f,
+    multVec4fArray,
+    multVec3fArray,
+    multVec3fSoA,
+    avxMultMat4f,
+    transpose,
+    inverseRigidArray,
+    inverseAffineArray,
+    inverseArray,
+    identity,
+    translation,
+    mat_rotationScalar,
+    mat_rotationQuatScalar,
+    mat_perspectiveScalar,
+};
+
+#endif //MATRIX_AVX_H
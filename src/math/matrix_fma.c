@@ -0,0 +1,5 @@
+#define MADD128(a, b, c) _mm_fmadd_ps(a, b, c)
+#define MADD256(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define MATRIX_AVX_KERNELS mat_fmaKernels
+
+#include "matrix_avx.h"
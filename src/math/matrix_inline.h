@@ -0,0 +1,110 @@
+#ifndef MATRIX_INLINE_H
+#define MATRIX_INLINE_H
+
+/*
+ * SSE2 and AVX bodies of the cheapest matrix functions. The vector backends build their tables from them;
+ * inline math builds (see mathinline.h) call them directly, using the widest instruction set enabled at compile
+ * time instead of the backend picked at run time.
+ */
+
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+#include "matrix.h"
+
+#define MAT_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define MAT_SWIZZLE(v, x, y, z, w) MAT_SHUFFLE(v, v, x, y, z, w)
+
+static inline void sseMultVec4f(const Matrix4f *const m, const Vector4f *const v, Vector4f *const res) {
+    const __m128 in = _mm_loadu_ps(&v->x);
+    __m128 sum = _mm_mul_ps(_mm_load_ps(m->t[0]), MAT_SWIZZLE(in, 0, 0, 0, 0));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->t[1]), MAT_SWIZZLE(in, 1, 1, 1, 1)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->t[2]), MAT_SWIZZLE(in, 2, 2, 2, 2)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->t[3]), MAT_SWIZZLE(in, 3, 3, 3, 3)));
+    _mm_storeu_ps(&res->x, sum);
+}
+
+static inline void sseMultMat4f(const Matrix4f *const l, const Matrix4f *const r, Matrix4f *const res) {
+    const __m128 c0 = _mm_load_ps(l->t[0]);
+    const __m128 c1 = _mm_load_ps(l->t[1]);
+    const __m128 c2 = _mm_load_ps(l->t[2]);
+    const __m128 c3 = _mm_load_ps(l->t[3]);
+    for (int column = 0; column < 4; column++) {
+        const __m128 rc = _mm_load_ps(r->t[column]);
+        __m128 sum = _mm_mul_ps(c0, MAT_SWIZZLE(rc, 0, 0, 0, 0));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c1, MAT_SWIZZLE(rc, 1, 1, 1, 1)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c2, MAT_SWIZZLE(rc, 2, 2, 2, 2)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c3, MAT_SWIZZLE(rc, 3, 3, 3, 3)));
+        _mm_store_ps(res->t[column], sum);
+    }
+}
+
+static inline void sseIdentity(Matrix4f *const res) {
+    _mm_store_ps(res->t[0], _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f));
+    _mm_store_ps(res->t[1], _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f));
+    _mm_store_ps(res->t[2], _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f));
+    _mm_store_ps(res->t[3], _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+static inline void sseTranslation(Matrix4f *const res, const Vector3f *const pos) {
+    sseIdentity(res);
+    _mm_store_ps(res->t[3], _mm_setr_ps(pos->x, pos->y, pos->z, 1.0f));
+}
+
+#ifdef __AVX__
+// Broadcasts element i of each 128-bit lane, i.e. of each of the two loaded columns
+#define MAT_SPLAT256(v, i) _mm256_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+#ifdef __FMA__
+#define MAT_MADD256(a, b, c) _mm256_fmadd_ps(a, b, c)
+#else
+#define MAT_MADD256(a, b, c) _mm256_add_ps(_mm256_mul_ps(a, b), c)
+#endif
+
+static inline void avxMultMat4f(const Matrix4f *const l, const Matrix4f *const r, Matrix4f *const res) {
+    const __m256 c0 = _mm256_broadcast_ps((const __m128 *) l->t[0]);
+    const __m256 c1 = _mm256_broadcast_ps((const __m128 *) l->t[1]);
+    const __m256 c2 = _mm256_broadcast_ps((const __m128 *) l->t[2]);
+    const __m256 c3 = _mm256_broadcast_ps((const __m128 *) l->t[3]);
+    const __m256 r01 = _mm256_load_ps(r->t[0]);
+    const __m256 r23 = _mm256_load_ps(r->t[2]);
+
+    __m256 sum01 = _mm256_mul_ps(c0, MAT_SPLAT256(r01, 0));
+    __m256 sum23 = _mm256_mul_ps(c0, MAT_SPLAT256(r23, 0));
+    sum01 = MAT_MADD256(c1, MAT_SPLAT256(r01, 1), sum01);
+    sum23 = MAT_MADD256(c1, MAT_SPLAT256(r23, 1), sum23);
+    sum01 = MAT_MADD256(c2, MAT_SPLAT256(r01, 2), sum01);
+    sum23 = MAT_MADD256(c2, MAT_SPLAT256(r23, 2), sum23);
+    sum01 = MAT_MADD256(c3, MAT_SPLAT256(r01, 3), sum01);
+    sum23 = MAT_MADD256(c3, MAT_SPLAT256(r23, 3), sum23);
+
+    _mm256_store_ps(res->t[0], sum01);
+    _mm256_store_ps(res->t[2], sum23);
+}
+#endif
+
+#ifdef MATRIX_INLINE
+static inline void mat_multVec4f(const Matrix4f *const m, const Vector4f *const v, Vector4f *const res) {
+    sseMultVec4f(m, v, res);
+}
+
+static inline void mat_multMat4f(const Matrix4f *const l, const Matrix4f *const r, Matrix4f *const res) {
+#ifdef __AVX__
+    avxMultMat4f(l, r, res);
+#else
+    sseMultMat4f(l, r, res);
+#endif
+}
+
+static inline void mat_identity(Matrix4f *const res) {
+    sseIdentity(res);
+}
+
+static inline void mat_translation(Matrix4f *const res, const Vector3f *const pos) {
+    sseTranslation(res, pos);
+}
+#endif
+
+#endif //MATRIX_INLINE_H
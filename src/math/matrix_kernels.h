@@ -0,0 +1,52 @@
+#ifndef MATRIX_KERNELS_H
+#define MATRIX_KERNELS_H
+
+#include "matrix.h"
+
+/**
+ * One implementation of the matrix.h functions. The mat_* functions forward to the table of the selected backend.
+ * Every kernel writes the whole result matrix and tolerates res aliasing its inputs.
+ */
+typedef struct {
+    void (*multVec4f)(const Matrix4f *m, const Vector4f *v, Vector4f *res);
+    void (*multVec4fArray)(const Matrix4f *m, const Vector4f *in, Vector4f *out, size_t count, unsigned flags);
+    void (*multVec3fArray)(const Matrix4f *m, const Vector3f *in, Vector3f *out, size_t count, unsigned flags);
+    void (*multVec3fSoA)(const Matrix4f *m, const float *x, const float *y, const float *z,
+                         float *outX, float *outY, float *outZ, size_t count, unsigned flags);
+    void (*multMat4f)(const Matrix4f *l, const Matrix4f *r, Matrix4f *res);
+    void (*transpose)(const Matrix4f *m, Matrix4f *res);
+    void (*inverseRigidArray)(const Matrix4f *in, Matrix4f *out, size_t count);
+    bool (*inverseAffineArray)(const Matrix4f *in, Matrix4f *out, size_t count);
+    bool (*inverseArray)(const Matrix4f *in, Matrix4f *out, size_t count);
+    void (*identity)(Matrix4f *res);
+    void (*translation)(Matrix4f *res, const Vector3f *pos);
+    void (*rotation)(Matrix4f *res, const Vector3f *rot);
+    void (*rotationQuat)(Matrix4f *res, const Quatf *q);
+    void (*perspective)(Matrix4f *res, float aspect, float fov, float near, float far);
+} MatrixKernels;
+
+extern const MatrixKernels mat_scalarKernels;
+#if defined(__x86_64__) || defined(__i386__)
+extern const MatrixKernels mat_sse2Kernels;
+extern const MatrixKernels mat_avxKernels;
+extern const MatrixKernels mat_fmaKernels;
+#endif
+
+// The vector backends finish the elements that do not fill a whole register with these
+void mat_multVec4fArrayScalar(const Matrix4f *m, const Vector4f *in, Vector4f *out, size_t count, unsigned flags);
+
+void mat_multVec3fArrayScalar(const Matrix4f *m, const Vector3f *in, Vector3f *out, size_t count, unsigned flags);
+
+void mat_multVec3fSoAScalar(const Matrix4f *m, const float *x, const float *y, const float *z,
+                            float *outX, float *outY, float *outZ, size_t count, unsigned flags);
+
+// Builders bound by scalar setup or trigonometry have no SIMD counterpart, the vector backends share these
+void mat_rotationSinCos(Matrix4f *res, float xSin, float xCos, float ySin, float yCos, float zSin, float zCos);
+
+void mat_rotationScalar(Matrix4f *res, const Vector3f *rot);
+
+void mat_rotationQuatScalar(Matrix4f *res, const Quatf *q);
+
+void mat_perspectiveScalar(Matrix4f *res, float aspect, float fov, float near, float far);
+
+#endif //MATRIX_KERNELS_H
@@ -0,0 +1,272 @@
+#include "matrix_kernels.h"
+
+#include "fastmath.h"
+
+static void multVec4f(const Matrix4f *const m, const Vector4f *const v, Vector4f *const res) {
+    const Vector4f in = *v;
+    res->x = m->t[0][0] * in.x + m->t[1][0] * in.y + m->t[2][0] * in.z + m->t[3][0] * in.w;
+    res->y = m->t[0][1] * in.x + m->t[1][1] * in.y + m->t[2][1] * in.z + m->t[3][1] * in.w;
+    res->z = m->t[0][2] * in.x + m->t[1][2] * in.y + m->t[2][2] * in.z + m->t[3][2] * in.w;
+    res->w = m->t[0][3] * in.x + m->t[1][3] * in.y + m->t[2][3] * in.z + m->t[3][3] * in.w;
+}
+
+void mat_multVec4fArrayScalar(const Matrix4f *const m, const Vector4f *const in, Vector4f *const out,
+                              const size_t count, const unsigned flags) {
+    for (size_t i = 0; i < count; i++) {
+        Vector4f res;
+        multVec4f(m, in + i, &res);
+        if (flags & MAT_TRANSFORM_DIVIDE) {
+            res.x /= res.w;
+            res.y /= res.w;
+            res.z /= res.w;
+            res.w = 1.0f;
+        }
+        out[i] = res;
+    }
+}
+
+static void multVec3f(const Matrix4f *const m, const float x, const float y, const float z, const unsigned flags,
+                      float *const outX, float *const outY, float *const outZ) {
+    const float w = flags & MAT_TRANSFORM_DIRECTION ? 0.0f : 1.0f;
+    float resX = m->t[0][0] * x + m->t[1][0] * y + m->t[2][0] * z + m->t[3][0] * w;
+    float resY = m->t[0][1] * x + m->t[1][1] * y + m->t[2][1] * z + m->t[3][1] * w;
+    float resZ = m->t[0][2] * x + m->t[1][2] * y + m->t[2][2] * z + m->t[3][2] * w;
+    if (flags & MAT_TRANSFORM_DIVIDE) {
+        const float resW = m->t[0][3] * x + m->t[1][3] * y + m->t[2][3] * z + m->t[3][3] * w;
+        resX /= resW;
+        resY /= resW;
+        resZ /= resW;
+    }
+    *outX = resX;
+    *outY = resY;
+    *outZ = resZ;
+}
+
+void mat_multVec3fArrayScalar(const Matrix4f *const m, const Vector3f *const in, Vector3f *const out,
+                              const size_t count, const unsigned flags) {
+    for (size_t i = 0; i < count; i++) {
+        const Vector3f v = in[i];
+        multVec3f(m, v.x, v.y, v.z, flags, &out[i].x, &out[i].y, &out[i].z);
+    }
+}
+
+void mat_multVec3fSoAScalar(const Matrix4f *const m, const float *const x, const float *const y,
+                            const float *const z, float *const outX, float *const outY, float *const outZ,
+                            const size_t count, const unsigned flags) {
+    for (size_t i = 0; i < count; i++) {
+        multVec3f(m, x[i], y[i], z[i], flags, outX + i, outY + i, outZ + i);
+    }
+}
+
+static void multMat4f(const Matrix4f *const l, const Matrix4f *const r, Matrix4f *const res) {
+    Matrix4f product;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int i = 0; i < 4; i++) {
+                sum += l->t[i][row] * r->t[column][i];
+            }
+            product.t[column][row] = sum;
+        }
+    }
+    *res = product;
+}
+
+static void transpose(const Matrix4f *const m, Matrix4f *const res) {
+    Matrix4f transposed;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            transposed.t[row][column] = m->t[column][row];
+        }
+    }
+    *res = transposed;
+}
+
+static void inverseRigidArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const Matrix4f m = in[i];
+        for (int column = 0; column < 3; column++) {
+            for (int row = 0; row < 3; row++) {
+                out[i].t[column][row] = m.t[row][column];
+            }
+            out[i].t[column][3] = 0.0f;
+            out[i].t[3][column] = -(m.t[column][0] * m.t[3][0] + m.t[column][1] * m.t[3][1] +
+                                    m.t[column][2] * m.t[3][2]);
+        }
+        out[i].t[3][3] = 1.0f;
+    }
+}
+
+static bool inverseAffine(const Matrix4f *const m, Matrix4f *const res) {
+    const float (*const a)[4] = m->t;
+    // Rows of the inverted 3x3 part are the cross products of its columns divided by the determinant
+    const float r0[3] = {
+        a[1][1] * a[2][2] - a[1][2] * a[2][1], a[1][2] * a[2][0] - a[1][0] * a[2][2],
+        a[1][0] * a[2][1] - a[1][1] * a[2][0]
+    };
+    const float r1[3] = {
+        a[2][1] * a[0][2] - a[2][2] * a[0][1], a[2][2] * a[0][0] - a[2][0] * a[0][2],
+        a[2][0] * a[0][1] - a[2][1] * a[0][0]
+    };
+    const float r2[3] = {
+        a[0][1] * a[1][2] - a[0][2] * a[1][1], a[0][2] * a[1][0] - a[0][0] * a[1][2],
+        a[0][0] * a[1][1] - a[0][1] * a[1][0]
+    };
+    const float det = a[0][0] * r0[0] + a[0][1] * r0[1] + a[0][2] * r0[2];
+    if (det == 0.0f) return false;
+
+    const float invDet = 1.0f / det;
+    Matrix4f inverse;
+    for (int column = 0; column < 3; column++) {
+        inverse.t[column][0] = r0[column] * invDet;
+        inverse.t[column][1] = r1[column] * invDet;
+        inverse.t[column][2] = r2[column] * invDet;
+        inverse.t[column][3] = 0.0f;
+    }
+    for (int row = 0; row < 3; row++) {
+        inverse.t[3][row] = -(inverse.t[0][row] * a[3][0] + inverse.t[1][row] * a[3][1] +
+                              inverse.t[2][row] * a[3][2]);
+    }
+    inverse.t[3][3] = 1.0f;
+    *res = inverse;
+    return true;
+}
+
+static bool inverseAffineArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    bool isInvertible = true;
+    for (size_t i = 0; i < count; i++) {
+        isInvertible &= inverseAffine(in + i, out + i);
+    }
+    return isInvertible;
+}
+
+static bool inverse(const Matrix4f *const m, Matrix4f *const res) {
+    const float (*const a)[4] = m->t;
+    // 2x2 minors of the first two and the last two columns, as in the Laplace expansion
+    const float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    const float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    const float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    const float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    const float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    const float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+    const float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    const float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    const float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    const float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    const float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    const float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+    const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == 0.0f) return false;
+
+    const float invDet = 1.0f / det;
+    *res = (Matrix4f) {{
+        {
+            (a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * invDet,
+            (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * invDet,
+            (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * invDet,
+            (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * invDet,
+        },
+        {
+            (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * invDet,
+            (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * invDet,
+            (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * invDet,
+            (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * invDet,
+        },
+        {
+            (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * invDet,
+            (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * invDet,
+            (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * invDet,
+            (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * invDet,
+        },
+        {
+            (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * invDet,
+            (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * invDet,
+            (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * invDet,
+            (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * invDet,
+        },
+    }};
+    return true;
+}
+
+static bool inverseArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    bool isInvertible = true;
+    for (size_t i = 0; i < count; i++) {
+        isInvertible &= inverse(in + i, out + i);
+    }
+    return isInvertible;
+}
+
+static void identity(Matrix4f *const res) {
+    *res = (Matrix4f) {{
+        {1.0f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 0.0f, 1.0f},
+    }};
+}
+
+static void translation(Matrix4f *const res, const Vector3f *const pos) {
+    identity(res);
+    res->t[3][0] = pos->x;
+    res->t[3][1] = pos->y;
+    res->t[3][2] = pos->z;
+}
+
+void mat_rotationSinCos(Matrix4f *const res, const float xSin, const float xCos, const float ySin, const float yCos,
+                        const float zSin, const float zCos) {
+    *res = (Matrix4f) {{
+        {yCos * zCos, xSin * ySin * zCos - xCos * zSin, xCos * ySin * zCos + xSin * zSin, 0.0f},
+        {yCos * zSin, xSin * ySin * zSin + xCos * zCos, xCos * ySin * zSin - xSin * zCos, 0.0f},
+        {-ySin, xSin * yCos, xCos * yCos, 0.0f},
+        {0.0f, 0.0f, 0.0f, 1.0f},
+    }};
+}
+
+void mat_rotationScalar(Matrix4f *const res, const Vector3f *const rot) {
+    float xSin, xCos, ySin, yCos, zSin, zCos;
+    fm_sincosf(rot->x, &xSin, &xCos);
+    fm_sincosf(rot->y, &ySin, &yCos);
+    fm_sincosf(rot->z, &zSin, &zCos);
+    mat_rotationSinCos(res, xSin, xCos, ySin, yCos, zSin, zCos);
+}
+
+void mat_rotationQuatScalar(Matrix4f *const res, const Quatf *const q) {
+    const float xx = q->x * q->x, yy = q->y * q->y, zz = q->z * q->z;
+    const float xy = q->x * q->y, xz = q->x * q->z, yz = q->y * q->z;
+    const float wx = q->w * q->x, wy = q->w * q->y, wz = q->w * q->z;
+    *res = (Matrix4f) {{
+        {1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f},
+        {2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f},
+        {2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f},
+        {0.0f, 0.0f, 0.0f, 1.0f},
+    }};
+}
+
+void mat_perspectiveScalar(Matrix4f *const res, const float aspect, const float fov, const float near,
+                           const float far) {
+    const float fovFactor = 1.0f / fm_tanf(fov / 2.0f);
+    const float zFactor = far / (far - near);
+    *res = (Matrix4f) {{
+        {aspect * fovFactor, 0.0f, 0.0f, 0.0f},
+        {0.0f, fovFactor, 0.0f, 0.0f},
+        {0.0f, 0.0f, zFactor, 1.0f},
+        {0.0f, 0.0f, -zFactor * near, 0.0f},
+    }};
+}
+
+const MatrixKernels mat_scalarKernels = {
+    multVec4f,
+    mat_multVec4fArrayScalar,
+    mat_multVec3fArrayScalar,
+    mat_multVec3fSoAScalar,
+    multMat4f,
+    transpose,
+    inverseRigidArray,
+    inverseAffineArray,
+    inverseArray,
+    identity,
+    translation,
+    mat_rotationScalar,
+    mat_rotationQuatScalar,
+    mat_perspectiveScalar,
+};
@@ -0,0 +1,169 @@
+#ifndef MATRIX_SSE_H
+#define MATRIX_SSE_H
+
+/*
+ * 128-bit kernels shared by the SSE2 and AVX backends. Each column of a Matrix4f
+ * fills one register; the AVX backends get the VEX encoded versions by including this from their own files.
+ */
+
+#include <emmintrin.h>
+
+#include "matrix_inline.h"
+#include "matrix_kernels.h"
+
+static inline void transpose(const Matrix4f *const m, Matrix4f *const res) {
+    __m128 c0 = _mm_load_ps(m->t[0]);
+    __m128 c1 = _mm_load_ps(m->t[1]);
+    __m128 c2 = _mm_load_ps(m->t[2]);
+    __m128 c3 = _mm_load_ps(m->t[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_store_ps(res->t[0], c0);
+    _mm_store_ps(res->t[1], c1);
+    _mm_store_ps(res->t[2], c2);
+    _mm_store_ps(res->t[3], c3);
+}
+
+// Builds the inverse from its transposed 3x3 part, given as columns with w = 0, and the original translation
+static inline void storeAffineInverse(__m128 r0, __m128 r1, __m128 r2, const __m128 translation, Matrix4f *const res) {
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    __m128 moved = _mm_mul_ps(r0, MAT_SWIZZLE(translation, 0, 0, 0, 0));
+    moved = _mm_add_ps(moved, _mm_mul_ps(r1, MAT_SWIZZLE(translation, 1, 1, 1, 1)));
+    moved = _mm_add_ps(moved, _mm_mul_ps(r2, MAT_SWIZZLE(translation, 2, 2, 2, 2)));
+    _mm_store_ps(res->t[0], r0);
+    _mm_store_ps(res->t[1], r1);
+    _mm_store_ps(res->t[2], r2);
+    _mm_store_ps(res->t[3], _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), moved));
+}
+
+static inline void inverseRigidArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    for (size_t i = 0; i < count; i++) {
+        const __m128 c0 = _mm_and_ps(_mm_load_ps(in[i].t[0]), xyzMask);
+        const __m128 c1 = _mm_and_ps(_mm_load_ps(in[i].t[1]), xyzMask);
+        const __m128 c2 = _mm_and_ps(_mm_load_ps(in[i].t[2]), xyzMask);
+        // The transposed rotation is the inverse, so the rows of the rotation become the columns
+        storeAffineInverse(c0, c1, c2, _mm_load_ps(in[i].t[3]), out + i);
+    }
+}
+
+static inline __m128 cross(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(MAT_SWIZZLE(a, 1, 2, 0, 3), MAT_SWIZZLE(b, 2, 0, 1, 3)),
+        _mm_mul_ps(MAT_SWIZZLE(a, 2, 0, 1, 3), MAT_SWIZZLE(b, 1, 2, 0, 3))
+    );
+}
+
+static inline __m128 horizontalSum(const __m128 v) {
+    const __m128 pairs = _mm_add_ps(v, MAT_SWIZZLE(v, 2, 3, 0, 1));
+    return _mm_add_ps(pairs, MAT_SWIZZLE(pairs, 1, 0, 3, 2));
+}
+
+static inline bool inverseAffineArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    bool isInvertible = true;
+    for (size_t i = 0; i < count; i++) {
+        const __m128 c0 = _mm_and_ps(_mm_load_ps(in[i].t[0]), xyzMask);
+        const __m128 c1 = _mm_and_ps(_mm_load_ps(in[i].t[1]), xyzMask);
+        const __m128 c2 = _mm_and_ps(_mm_load_ps(in[i].t[2]), xyzMask);
+        // Rows of the inverted 3x3 part are the cross products of its columns divided by the determinant
+        const __m128 r0 = cross(c1, c2);
+        const __m128 det = horizontalSum(_mm_mul_ps(c0, r0));
+        if (_mm_cvtss_f32(det) == 0.0f) {
+            isInvertible = false;
+            continue;
+        }
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        storeAffineInverse(
+            _mm_mul_ps(r0, invDet),
+            _mm_mul_ps(cross(c2, c0), invDet),
+            _mm_mul_ps(cross(c0, c1), invDet),
+            _mm_load_ps(in[i].t[3]),
+            out + i
+        );
+    }
+    return isInvertible;
+}
+
+// 2x2 matrices packed as (m00, m01, m10, m11): a * b, adj(a) * b and a * adj(b)
+static inline __m128 mat2Mul(const __m128 a, const __m128 b) {
+    return _mm_add_ps(
+        _mm_mul_ps(a, MAT_SWIZZLE(b, 0, 3, 0, 3)),
+        _mm_mul_ps(MAT_SWIZZLE(a, 1, 0, 3, 2), MAT_SWIZZLE(b, 2, 1, 2, 1))
+    );
+}
+
+static inline __m128 mat2AdjMul(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(MAT_SWIZZLE(a, 3, 3, 0, 0), b),
+        _mm_mul_ps(MAT_SWIZZLE(a, 1, 1, 2, 2), MAT_SWIZZLE(b, 2, 3, 0, 1))
+    );
+}
+
+static inline __m128 mat2MulAdj(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(a, MAT_SWIZZLE(b, 3, 0, 3, 0)),
+        _mm_mul_ps(MAT_SWIZZLE(a, 1, 0, 3, 2), MAT_SWIZZLE(b, 2, 1, 2, 1))
+    );
+}
+
+/*
+ * Cramer's rule over 2x2 blocks: with M = |A B|, the inverse is adj(M) / det(M), where every block of adj(M)
+ *                                         |C D|
+ * and det(M) itself only need 2x2 products, adjugates and determinants of A, B, C and D.
+ */
+static inline bool inverse(const Matrix4f *const m, Matrix4f *const res) {
+    const __m128 c0 = _mm_load_ps(m->t[0]);
+    const __m128 c1 = _mm_load_ps(m->t[1]);
+    const __m128 c2 = _mm_load_ps(m->t[2]);
+    const __m128 c3 = _mm_load_ps(m->t[3]);
+    const __m128 a = _mm_movelh_ps(c0, c1);
+    const __m128 b = _mm_movehl_ps(c1, c0);
+    const __m128 c = _mm_movelh_ps(c2, c3);
+    const __m128 d = _mm_movehl_ps(c3, c2);
+
+    // (det(A), det(B), det(C), det(D))
+    const __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(MAT_SHUFFLE(c0, c2, 0, 2, 0, 2), MAT_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(MAT_SHUFFLE(c0, c2, 1, 3, 1, 3), MAT_SHUFFLE(c1, c3, 0, 2, 0, 2))
+    );
+    const __m128 detA = MAT_SWIZZLE(detSub, 0, 0, 0, 0);
+    const __m128 detB = MAT_SWIZZLE(detSub, 1, 1, 1, 1);
+    const __m128 detC = MAT_SWIZZLE(detSub, 2, 2, 2, 2);
+    const __m128 detD = MAT_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    const __m128 dc = mat2AdjMul(d, c);
+    const __m128 ab = mat2AdjMul(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+    // det(M) = det(A) det(D) + det(B) det(C) - tr(adj(A) B adj(D) C)
+    const __m128 trace = horizontalSum(_mm_mul_ps(ab, MAT_SWIZZLE(dc, 0, 2, 1, 3)));
+    const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+    if (_mm_cvtss_f32(det) == 0.0f) return false;
+
+    const __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, invDet);
+    y = _mm_mul_ps(y, invDet);
+    z = _mm_mul_ps(z, invDet);
+    w = _mm_mul_ps(w, invDet);
+
+    // The final shuffles apply the block adjugate and put the blocks back into columns
+    _mm_store_ps(res->t[0], MAT_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_store_ps(res->t[1], MAT_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_store_ps(res->t[2], MAT_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_store_ps(res->t[3], MAT_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+}
+
+static inline bool inverseArray(const Matrix4f *const in, Matrix4f *const out, const size_t count) {
+    bool isInvertible = true;
+    for (size_t i = 0; i < count; i++) {
+        isInvertible &= inverse(in + i, out + i);
+    }
+    return isInvertible;
+}
+
+#endif //MATRIX_SSE_H
@@ -0,0 +1,94 @@
+#include "matrix_kernels.h"
+
+#include <emmintrin.h>
+
+#include "matrix_sse.h"
+
+#define SPLAT(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+
+static __m128 divideByW(const __m128 v) {
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 divided = _mm_div_ps(v, SPLAT(v, 3));
+    return _mm_or_ps(_mm_and_ps(divided, xyzMask), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+static void multVec4fArray(const Matrix4f *const m, const Vector4f *const in, Vector4f *const out, const size_t count,
+                           const unsigned flags) {
+    const __m128 c0 = _mm_load_ps(m->t[0]);
+    const __m128 c1 = _mm_load_ps(m->t[1]);
+    const __m128 c2 = _mm_load_ps(m->t[2]);
+    const __m128 c3 = _mm_load_ps(m->t[3]);
+    for (size_t i = 0; i < count; i++) {
+        const __m128 v = _mm_loadu_ps(&in[i].x);
+        __m128 sum = _mm_mul_ps(c0, SPLAT(v, 0));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c1, SPLAT(v, 1)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c2, SPLAT(v, 2)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c3, SPLAT(v, 3)));
+        if (flags & MAT_TRANSFORM_DIVIDE) sum = divideByW(sum);
+        _mm_storeu_ps(&out[i].x, sum);
+    }
+}
+
+static void multVec3fArray(const Matrix4f *const m, const Vector3f *const in, Vector3f *const out, const size_t count,
+                           const unsigned flags) {
+    const __m128 c0 = _mm_load_ps(m->t[0]);
+    const __m128 c1 = _mm_load_ps(m->t[1]);
+    const __m128 c2 = _mm_load_ps(m->t[2]);
+    const __m128 c3 = flags & MAT_TRANSFORM_DIRECTION ? _mm_setzero_ps() : _mm_load_ps(m->t[3]);
+    for (size_t i = 0; i < count; i++) {
+        __m128 sum = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(in[i].x)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+        if (flags & MAT_TRANSFORM_DIVIDE) sum = _mm_div_ps(sum, SPLAT(sum, 3));
+        _mm_storel_pi((__m64 *) &out[i].x, sum);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(sum, sum));
+    }
+}
+
+static void multVec3fSoA(const Matrix4f *const m, const float *const x, const float *const y, const float *const z,
+                         float *const outX, float *const outY, float *const outZ, const size_t count,
+                         const unsigned flags) {
+    const float w = flags & MAT_TRANSFORM_DIRECTION ? 0.0f : 1.0f;
+    __m128 e[4][4];
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 4; row++) e[column][row] = _mm_set1_ps(m->t[column][row]);
+    }
+    for (int row = 0; row < 4; row++) e[3][row] = _mm_set1_ps(m->t[3][row] * w);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 vx = _mm_loadu_ps(x + i);
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 vz = _mm_loadu_ps(z + i);
+        __m128 res[4];
+        for (int row = 0; row < 4; row++) {
+            __m128 sum = _mm_add_ps(e[3][row], _mm_mul_ps(e[0][row], vx));
+            sum = _mm_add_ps(sum, _mm_mul_ps(e[1][row], vy));
+            res[row] = _mm_add_ps(sum, _mm_mul_ps(e[2][row], vz));
+        }
+        if (flags & MAT_TRANSFORM_DIVIDE) {
+            for (int row = 0; row < 3; row++) res[row] = _mm_div_ps(res[row], res[3]);
+        }
+        _mm_storeu_ps(outX + i, res[0]);
+        _mm_storeu_ps(outY + i, res[1]);
+        _mm_storeu_ps(outZ + i, res[2]);
+    }
+    mat_multVec3fSoAScalar(m, x + i, y + i, z + i, outX + i, outY + i, outZ + i, count - i, flags);
+}
+
+const MatrixKernels mat_sse2Kernels = {
+    sseMultVec4f,
+    multVec4fArray,
+    multVec3fArray,
+    multVec3fSoA,
+    sseMultMat4f,
+    transpose,
+    inverseRigidArray,
+    inverseAffineArray,
+    inverseArray,
+    sseIdentity,
+    sseTranslation,
+    mat_rotationScalar,
+    mat_rotationQuatScalar,
+    mat_perspectiveScalar,
+};
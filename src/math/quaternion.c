@@ -0,0 +1,90 @@
+#include "quaternion.h"
+
+#include <math.h>
+
+#include "fastmath.h"
+
+void quat_identity(Quatf *const res) {
+    *res = (Quatf) {0.0f, 0.0f, 0.0f, 1.0f};
+}
+
+void quat_fromAxisAngle(Quatf *const res, const Vector3f *const axis, const float angle) {
+    const float length = sqrtf(axis->x * axis->x + axis->y * axis->y + axis->z * axis->z);
+    float halfSin, halfCos;
+    fm_sincosf(angle / 2.0f, &halfSin, &halfCos);
+    const float factor = halfSin / length;
+    *res = (Quatf) {axis->x * factor, axis->y * factor, axis->z * factor, halfCos};
+}
+
+void quat_fromEuler(Quatf *const res, const Vector3f *const rot) {
+    float xSin, xCos, ySin, yCos, zSin, zCos;
+    fm_sincosf(rot->x / 2.0f, &xSin, &xCos);
+    fm_sincosf(rot->y / 2.0f, &ySin, &yCos);
+    fm_sincosf(rot->z / 2.0f, &zSin, &zCos);
+    // mat_rotation builds the transpose of Rz * Ry * Rx, so this is the conjugate of qz * qy * qx
+    *res = (Quatf) {
+        -(xSin * yCos * zCos - xCos * ySin * zSin),
+        -(xCos * ySin * zCos + xSin * yCos * zSin),
+        -(xCos * yCos * zSin - xSin * ySin * zCos),
+        xCos * yCos * zCos + xSin * ySin * zSin,
+    };
+}
+
+void quat_mult(const Quatf *const l, const Quatf *const r, Quatf *const res) {
+    *res = (Quatf) {
+        l->w * r->x + l->x * r->w + l->y * r->z - l->z * r->y,
+        l->w * r->y - l->x * r->z + l->y * r->w + l->z * r->x,
+        l->w * r->z + l->x * r->y - l->y * r->x + l->z * r->w,
+        l->w * r->w - l->x * r->x - l->y * r->y - l->z * r->z,
+    };
+}
+
+void quat_conjugate(const Quatf *const q, Quatf *const res) {
+    *res = (Quatf) {-q->x, -q->y, -q->z, q->w};
+}
+
+void quat_normalize(const Quatf *const q, Quatf *const res) {
+    const float invLength = 1.0f / sqrtf(q->x * q->x + q->y * q->y + q->z * q->z + q->w * q->w);
+    *res = (Quatf) {q->x * invLength, q->y * invLength, q->z * invLength, q->w * invLength};
+}
+
+static float dot(const Quatf *const a, const Quatf *const b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+void quat_nlerp(const Quatf *const a, const Quatf *const b, const float t, Quatf *const res) {
+    // q and -q are the same rotation; flipping b keeps the interpolation on the shorter arc
+    const float bFactor = dot(a, b) < 0.0f ? -t : t;
+    const float aFactor = 1.0f - t;
+    const Quatf lerp = {
+        a->x * aFactor + b->x * bFactor,
+        a->y * aFactor + b->y * bFactor,
+        a->z * aFactor + b->z * bFactor,
+        a->w * aFactor + b->w * bFactor,
+    };
+    quat_normalize(&lerp, res);
+}
+
+void quat_slerp(const Quatf *const a, const Quatf *const b, const float t, Quatf *const res) {
+    float cosAngle = dot(a, b);
+    float sign = 1.0f;
+    if (cosAngle < 0.0f) {
+        cosAngle = -cosAngle;
+        sign = -1.0f;
+    }
+    // Nearly parallel quaternions make sin(angle) vanish; nlerp is indistinguishable there
+    if (cosAngle > 0.9995f) {
+        quat_nlerp(a, b, t, res);
+        return;
+    }
+    const float angle = acosf(cosAngle);
+    const float invSin = 1.0f / sinf(angle);
+    const float aFactor = sinf((1.0f - t) * angle) * invSin;
+    const float bFactor = sinf(t * angle) * invSin * sign;
+    *res = (Quatf) {
+        a->x * aFactor + b->x * bFactor,
+        a->y * aFactor + b->y * bFactor,
+        a->z * aFactor + b->z * bFactor,
+        a->w * aFactor + b->w * bFactor,
+    };
+}
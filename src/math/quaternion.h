@@ -0,0 +1,41 @@
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include "vector.h"
+
+/**
+ * Rotation quaternion, w being the scalar part. Rotation functions expect unit quaternions.
+ */
+typedef struct {
+    float x, y, z, w;
+} Quatf;
+
+void quat_identity(Quatf *res);
+
+void quat_fromAxisAngle(Quatf *res, const Vector3f *axis, float angle);
+
+/**
+ * Builds the same rotation as mat_rotation does from these Euler angles.
+ */
+void quat_fromEuler(Quatf *res, const Vector3f *rot);
+
+/**
+ * Composes rotations the way matrices do: the result applies r first, then l.
+ */
+void quat_mult(const Quatf *l, const Quatf *r, Quatf *res);
+
+void quat_conjugate(const Quatf *q, Quatf *res);
+
+void quat_normalize(const Quatf *q, Quatf *res);
+
+/**
+ * Normalized linear interpolation along the shorter arc. Needs no trigonometry; the angular speed is not constant.
+ */
+void quat_nlerp(const Quatf *a, const Quatf *b, float t, Quatf *res);
+
+/**
+ * Spherical linear interpolation along the shorter arc with constant angular speed.
+ */
+void quat_slerp(const Quatf *a, const Quatf *b, float t, Quatf *res);
+
+#endif //QUATERNION_H
@@ -1,8 +1,14 @@
 #ifndef RAD_H
 #define RAD_H
 
-float toRad(float degrees);
+#include "mathinline.h"
 
-float toDeg(float radians);
+MATH_API float toRad(float degrees);
+
+MATH_API float toDeg(float radians);
+
+#ifdef MATH_INLINE
+#include "rad_inline.h"
+#endif
 
 #endif //RAD_H
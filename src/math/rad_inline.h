@@ -0,0 +1,16 @@
+#ifndef RAD_INLINE_H
+#define RAD_INLINE_H
+
+#include <math.h>
+
+#include "rad.h"
+
+MATH_API float toRad(const float degrees) {
+    return degrees * ((float) M_PI / 180.0f);
+}
+
+MATH_API float toDeg(const float radians) {
+    return radians * (180.0f / (float) M_PI);
+}
+
+#endif //RAD_INLINE_H
@@ -1,7 +1,254 @@
+#define MATH_OUT_OF_LINE
 #include "vector.h"
+#include "vector_inline.h"
 
-void vec_multNum3f(const Vector3f *const v, const float n, Vector3f *const res) {
-    res->x = v->x * n;
-    res->y = v->y * n;
-    res->z = v->z * n;
+/*
+ * Component-wise operations treat the vectors as one flat float array, which every vector size shares and the
+ * compiler vectorizes. Dot products, cross products and normalization need whole vectors per lane: the SSE2 paths
+ * transpose four of them at a time into x, y, z (and w) registers.
+ */
+
+static void addFloats(const float *const a, const float *const b, float *const res, const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = a[i] + b[i];
+}
+
+static void subFloats(const float *const a, const float *const b, float *const res, const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = a[i] - b[i];
+}
+
+static void multNumFloats(const float *const v, const float n, float *const res, const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = v[i] * n;
+}
+
+static void minFloats(const float *const a, const float *const b, float *const res, const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = vecMin(a[i], b[i]);
+}
+
+static void maxFloats(const float *const a, const float *const b, float *const res, const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = vecMax(a[i], b[i]);
+}
+
+static void lerpFloats(const float *const a, const float *const b, const float t, float *const res,
+                       const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = a[i] + (b[i] - a[i]) * t;
+}
+
+static void fmaFloats(const float *const a, const float *const b, const float *const c, float *const res,
+                      const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = a[i] * b[i] + c[i];
+}
+
+#ifdef __SSE2__
+/**
+ * Loads four consecutive Vector3f (twelve floats in three registers) as x, y and z registers.
+ */
+static void load3fSoA(const Vector3f *const v, __m128 *const x, __m128 *const y, __m128 *const z) {
+    const __m128 m0 = _mm_loadu_ps(&v[0].x); // x0 y0 z0 x1
+    const __m128 m1 = _mm_loadu_ps(&v[1].y); // y1 z1 x2 y2
+    const __m128 m2 = _mm_loadu_ps(&v[2].z); // z2 x3 y3 z3
+    const __m128 x1y1 = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 3, 3));
+    __m128 r0 = m0;
+    __m128 r1 = _mm_shuffle_ps(x1y1, x1y1, _MM_SHUFFLE(3, 3, 2, 0));
+    __m128 r2 = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128 r3 = _mm_shuffle_ps(m2, m2, _MM_SHUFFLE(3, 3, 2, 1));
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    *x = r0;
+    *y = r1;
+    *z = r2;
+}
+
+static void store3fSoA(Vector3f *const v, const __m128 x, const __m128 y, const __m128 z) {
+    __m128 r0 = x, r1 = y, r2 = z, r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    const __m128 z0x1 = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 2, 2));
+    const __m128 z2x3 = _mm_shuffle_ps(r2, r3, _MM_SHUFFLE(0, 0, 2, 2));
+    _mm_storeu_ps(&v[0].x, _mm_shuffle_ps(r0, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(&v[1].y, _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 0, 2, 1)));
+    _mm_storeu_ps(&v[2].z, _mm_shuffle_ps(z2x3, r3, _MM_SHUFFLE(2, 1, 2, 0)));
+}
+
+static __m128 inverseLength(const __m128 squaredLength) {
+    const __m128 isNonZero = _mm_cmpgt_ps(squaredLength, _mm_setzero_ps());
+    return _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(squaredLength)), isNonZero);
+}
+#endif
+
+void vec_add2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], const size_t count) {
+    addFloats(&a->x, &b->x, &res->x, 2 * count);
+}
+
+void vec_sub2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], const size_t count) {
+    subFloats(&a->x, &b->x, &res->x, 2 * count);
+}
+
+void vec_multNum2fArray(const Vector2f v[], const float n, Vector2f res[], const size_t count) {
+    multNumFloats(&v->x, n, &res->x, 2 * count);
+}
+
+void vec_dot2fArray(const Vector2f a[], const Vector2f b[], float res[], const size_t count) {
+    for (size_t i = 0; i < count; i++) res[i] = vec_dot2f(a + i, b + i);
+}
+
+void vec_normalize2fArray(const Vector2f v[], Vector2f res[], const size_t count) {
+    for (size_t i = 0; i < count; i++) vec_normalize2f(v + i, res + i);
+}
+
+void vec_min2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], const size_t count) {
+    minFloats(&a->x, &b->x, &res->x, 2 * count);
+}
+
+void vec_max2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], const size_t count) {
+    maxFloats(&a->x, &b->x, &res->x, 2 * count);
+}
+
+void vec_lerp2fArray(const Vector2f a[], const Vector2f b[], const float t, Vector2f res[], const size_t count) {
+    lerpFloats(&a->x, &b->x, t, &res->x, 2 * count);
+}
+
+void vec_fma2fArray(const Vector2f a[], const Vector2f b[], const Vector2f c[], Vector2f res[], const size_t count) {
+    fmaFloats(&a->x, &b->x, &c->x, &res->x, 2 * count);
+}
+
+void vec_add3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], const size_t count) {
+    addFloats(&a->x, &b->x, &res->x, 3 * count);
+}
+
+void vec_sub3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], const size_t count) {
+    subFloats(&a->x, &b->x, &res->x, 3 * count);
+}
+
+void vec_multNum3fArray(const Vector3f v[], const float n, Vector3f res[], const size_t count) {
+    multNumFloats(&v->x, n, &res->x, 3 * count);
+}
+
+void vec_dot3fArray(const Vector3f a[], const Vector3f b[], float res[], const size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= count; i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        load3fSoA(a + i, &ax, &ay, &az);
+        load3fSoA(b + i, &bx, &by, &bz);
+        const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+        _mm_storeu_ps(res + i, dot);
+    }
+#endif
+    for (; i < count; i++) res[i] = vec_dot3f(a + i, b + i);
+}
+
+void vec_cross3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], const size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= count; i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        load3fSoA(a + i, &ax, &ay, &az);
+        load3fSoA(b + i, &bx, &by, &bz);
+        store3fSoA(
+            res + i,
+            _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)),
+            _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)),
+            _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx))
+        );
+    }
+#endif
+    for (; i < count; i++) vec_cross3f(a + i, b + i, res + i);
+}
+
+void vec_normalize3fArray(const Vector3f v[], Vector3f res[], const size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        load3fSoA(v + i, &x, &y, &z);
+        const __m128 inv = inverseLength(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        store3fSoA(res + i, _mm_mul_ps(x, inv), _mm_mul_ps(y, inv), _mm_mul_ps(z, inv));
+    }
+#endif
+    for (; i < count; i++) vec_normalize3f(v + i, res + i);
+}
+
+void vec_min3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], const size_t count) {
+    minFloats(&a->x, &b->x, &res->x, 3 * count);
+}
+
+void vec_max3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], const size_t count) {
+    maxFloats(&a->x, &b->x, &res->x, 3 * count);
+}
+
+void vec_lerp3fArray(const Vector3f a[], const Vector3f b[], const float t, Vector3f res[], const size_t count) {
+    lerpFloats(&a->x, &b->x, t, &res->x, 3 * count);
+}
+
+void vec_fma3fArray(const Vector3f a[], const Vector3f b[], const Vector3f c[], Vector3f res[], const size_t count) {
+    fmaFloats(&a->x, &b->x, &c->x, &res->x, 3 * count);
+}
+
+void vec_add4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], const size_t count) {
+    addFloats(&a->x, &b->x, &res->x, 4 * count);
+}
+
+void vec_sub4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], const size_t count) {
+    subFloats(&a->x, &b->x, &res->x, 4 * count);
+}
+
+void vec_multNum4fArray(const Vector4f v[], const float n, Vector4f res[], const size_t count) {
+    multNumFloats(&v->x, n, &res->x, 4 * count);
+}
+
+void vec_dot4fArray(const Vector4f a[], const Vector4f b[], float res[], const size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= count; i += 4) {
+        __m128 p0 = _mm_mul_ps(_mm_loadu_ps(&a[i].x), _mm_loadu_ps(&b[i].x));
+        __m128 p1 = _mm_mul_ps(_mm_loadu_ps(&a[i + 1].x), _mm_loadu_ps(&b[i + 1].x));
+        __m128 p2 = _mm_mul_ps(_mm_loadu_ps(&a[i + 2].x), _mm_loadu_ps(&b[i + 2].x));
+        __m128 p3 = _mm_mul_ps(_mm_loadu_ps(&a[i + 3].x), _mm_loadu_ps(&b[i + 3].x));
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+        _mm_storeu_ps(res + i, _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3)));
+    }
+#endif
+    for (; i < count; i++) res[i] = vec_dot4f(a + i, b + i);
+}
+
+void vec_normalize4fArray(const Vector4f v[], Vector4f res[], const size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v0 = _mm_loadu_ps(&v[i].x);
+        const __m128 v1 = _mm_loadu_ps(&v[i + 1].x);
+        const __m128 v2 = _mm_loadu_ps(&v[i + 2].x);
+        const __m128 v3 = _mm_loadu_ps(&v[i + 3].x);
+        __m128 s0 = _mm_mul_ps(v0, v0), s1 = _mm_mul_ps(v1, v1), s2 = _mm_mul_ps(v2, v2), s3 = _mm_mul_ps(v3, v3);
+        _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+        const __m128 inv = inverseLength(_mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+        _mm_storeu_ps(&res[i].x, _mm_mul_ps(v0, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(0, 0, 0, 0))));
+        _mm_storeu_ps(&res[i + 1].x, _mm_mul_ps(v1, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(1, 1, 1, 1))));
+        _mm_storeu_ps(&res[i + 2].x, _mm_mul_ps(v2, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(2, 2, 2, 2))));
+        _mm_storeu_ps(&res[i + 3].x, _mm_mul_ps(v3, _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(3, 3, 3, 3))));
+    }
+#endif
+    for (; i < count; i++) vec_normalize4f(v + i, res + i);
+}
+
+void vec_min4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], const size_t count) {
+    minFloats(&a->x, &b->x, &res->x, 4 * count);
+}
+
+void vec_max4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], const size_t count) {
+    maxFloats(&a->x, &b->x, &res->x, 4 * count);
+}
+
+void vec_lerp4fArray(const Vector4f a[], const Vector4f b[], const float t, Vector4f res[], const size_t count) {
+    lerpFloats(&a->x, &b->x, t, &res->x, 4 * count);
+}
+
+void vec_fma4fArray(const Vector4f a[], const Vector4f b[], const Vector4f c[], Vector4f res[], const size_t count) {
+    fmaFloats(&a->x, &b->x, &c->x, &res->x, 4 * count);
+}
+
+void vec_pad3fArray(const Vector3f v[], Vector3fPadded res[], const size_t count) {
+    for (size_t i = 0; i < count; i++) vec_pad3f(v + i, res + i);
+}
+
+void vec_unpad3fArray(const Vector3fPadded v[], Vector3f res[], const size_t count) {
+    for (size_t i = 0; i < count; i++) vec_unpad3f(v + i, res + i);
 }
@@ -1,6 +1,14 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include <stddef.h>
+
+#include "mathinline.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 typedef struct {
     float x, y;
 } Vector2f;
@@ -13,4 +21,189 @@ typedef struct {
     float x, y, z, w;
 } Vector4f;
 
+/**
+ * Vector3f padded to a full SSE register. The fourth lane is padding: vec_pad3f clears it and the 3fp functions
+ * keep it at zero, which lets them work on all four lanes at once.
+ */
+#ifdef __SSE2__
+typedef union {
+    struct {
+        float x, y, z, _pad;
+    };
+    __m128 m;
+} Vector3fPadded;
+#else
+typedef struct {
+    _Alignas(16) float x;
+    float y, z, _pad;
+} Vector3fPadded;
+#endif
+
+/*
+ * Single-value functions are inlined with DUMMY3D_INLINE_MATH. In every function res may alias an input.
+ * vec_fma computes a * b + c per component and vec_lerp computes a + (b - a) * t. Normalizing a zero vector
+ * gives a zero vector.
+ */
+
+MATH_API void vec_add2f(const Vector2f *a, const Vector2f *b, Vector2f *res);
+
+MATH_API void vec_sub2f(const Vector2f *a, const Vector2f *b, Vector2f *res);
+
+MATH_API void vec_multNum2f(const Vector2f *v, float n, Vector2f *res);
+
+MATH_API float vec_dot2f(const Vector2f *a, const Vector2f *b);
+
+/**
+ * Z component of the cross product of a and b extended with z = 0.
+ */
+MATH_API float vec_cross2f(const Vector2f *a, const Vector2f *b);
+
+MATH_API float vec_length2f(const Vector2f *v);
+
+MATH_API void vec_normalize2f(const Vector2f *v, Vector2f *res);
+
+MATH_API void vec_min2f(const Vector2f *a, const Vector2f *b, Vector2f *res);
+
+MATH_API void vec_max2f(const Vector2f *a, const Vector2f *b, Vector2f *res);
+
+MATH_API void vec_lerp2f(const Vector2f *a, const Vector2f *b, float t, Vector2f *res);
+
+MATH_API void vec_fma2f(const Vector2f *a, const Vector2f *b, const Vector2f *c, Vector2f *res);
+
+MATH_API void vec_add3f(const Vector3f *a, const Vector3f *b, Vector3f *res);
+
+MATH_API void vec_sub3f(const Vector3f *a, const Vector3f *b, Vector3f *res);
+
+MATH_API void vec_multNum3f(const Vector3f *v, float n, Vector3f *res);
+
+MATH_API float vec_dot3f(const Vector3f *a, const Vector3f *b);
+
+MATH_API void vec_cross3f(const Vector3f *a, const Vector3f *b, Vector3f *res);
+
+MATH_API float vec_length3f(const Vector3f *v);
+
+MATH_API void vec_normalize3f(const Vector3f *v, Vector3f *res);
+
+MATH_API void vec_min3f(const Vector3f *a, const Vector3f *b, Vector3f *res);
+
+MATH_API void vec_max3f(const Vector3f *a, const Vector3f *b, Vector3f *res);
+
+MATH_API void vec_lerp3f(const Vector3f *a, const Vector3f *b, float t, Vector3f *res);
+
+MATH_API void vec_fma3f(const Vector3f *a, const Vector3f *b, const Vector3f *c, Vector3f *res);
+
+MATH_API void vec_add4f(const Vector4f *a, const Vector4f *b, Vector4f *res);
+
+MATH_API void vec_sub4f(const Vector4f *a, const Vector4f *b, Vector4f *res);
+
+MATH_API void vec_multNum4f(const Vector4f *v, float n, Vector4f *res);
+
+MATH_API float vec_dot4f(const Vector4f *a, const Vector4f *b);
+
+MATH_API float vec_length4f(const Vector4f *v);
+
+MATH_API void vec_normalize4f(const Vector4f *v, Vector4f *res);
+
+MATH_API void vec_min4f(const Vector4f *a, const Vector4f *b, Vector4f *res);
+
+MATH_API void vec_max4f(const Vector4f *a, const Vector4f *b, Vector4f *res);
+
+MATH_API void vec_lerp4f(const Vector4f *a, const Vector4f *b, float t, Vector4f *res);
+
+MATH_API void vec_fma4f(const Vector4f *a, const Vector4f *b, const Vector4f *c, Vector4f *res);
+
+MATH_API void vec_pad3f(const Vector3f *v, Vector3fPadded *res);
+
+MATH_API void vec_unpad3f(const Vector3fPadded *v, Vector3f *res);
+
+MATH_API void vec_add3fp(const Vector3fPadded *a, const Vector3fPadded *b, Vector3fPadded *res);
+
+MATH_API void vec_sub3fp(const Vector3fPadded *a, const Vector3fPadded *b, Vector3fPadded *res);
+
+MATH_API void vec_multNum3fp(const Vector3fPadded *v, float n, Vector3fPadded *res);
+
+MATH_API float vec_dot3fp(const Vector3fPadded *a, const Vector3fPadded *b);
+
+MATH_API void vec_cross3fp(const Vector3fPadded *a, const Vector3fPadded *b, Vector3fPadded *res);
+
+MATH_API void vec_normalize3fp(const Vector3fPadded *v, Vector3fPadded *res);
+
+MATH_API void vec_min3fp(const Vector3fPadded *a, const Vector3fPadded *b, Vector3fPadded *res);
+
+MATH_API void vec_max3fp(const Vector3fPadded *a, const Vector3fPadded *b, Vector3fPadded *res);
+
+MATH_API void vec_lerp3fp(const Vector3fPadded *a, const Vector3fPadded *b, float t, Vector3fPadded *res);
+
+MATH_API void vec_fma3fp(const Vector3fPadded *a, const Vector3fPadded *b, const Vector3fPadded *c,
+                         Vector3fPadded *res);
+
+/*
+ * Array forms process count vectors and are always out of line. res may be the same array as an input but must not
+ * partially overlap one. The dot products go to a float array.
+ */
+
+void vec_add2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], size_t count);
+
+void vec_sub2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], size_t count);
+
+void vec_multNum2fArray(const Vector2f v[], float n, Vector2f res[], size_t count);
+
+void vec_dot2fArray(const Vector2f a[], const Vector2f b[], float res[], size_t count);
+
+void vec_normalize2fArray(const Vector2f v[], Vector2f res[], size_t count);
+
+void vec_min2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], size_t count);
+
+void vec_max2fArray(const Vector2f a[], const Vector2f b[], Vector2f res[], size_t count);
+
+void vec_lerp2fArray(const Vector2f a[], const Vector2f b[], float t, Vector2f res[], size_t count);
+
+void vec_fma2fArray(const Vector2f a[], const Vector2f b[], const Vector2f c[], Vector2f res[], size_t count);
+
+void vec_add3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], size_t count);
+
+void vec_sub3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], size_t count);
+
+void vec_multNum3fArray(const Vector3f v[], float n, Vector3f res[], size_t count);
+
+void vec_dot3fArray(const Vector3f a[], const Vector3f b[], float res[], size_t count);
+
+void vec_cross3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], size_t count);
+
+void vec_normalize3fArray(const Vector3f v[], Vector3f res[], size_t count);
+
+void vec_min3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], size_t count);
+
+void vec_max3fArray(const Vector3f a[], const Vector3f b[], Vector3f res[], size_t count);
+
+void vec_lerp3fArray(const Vector3f a[], const Vector3f b[], float t, Vector3f res[], size_t count);
+
+void vec_fma3fArray(const Vector3f a[], const Vector3f b[], const Vector3f c[], Vector3f res[], size_t count);
+
+void vec_add4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], size_t count);
+
+void vec_sub4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], size_t count);
+
+void vec_multNum4fArray(const Vector4f v[], float n, Vector4f res[], size_t count);
+
+void vec_dot4fArray(const Vector4f a[], const Vector4f b[], float res[], size_t count);
+
+void vec_normalize4fArray(const Vector4f v[], Vector4f res[], size_t count);
+
+void vec_min4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], size_t count);
+
+void vec_max4fArray(const Vector4f a[], const Vector4f b[], Vector4f res[], size_t count);
+
+void vec_lerp4fArray(const Vector4f a[], const Vector4f b[], float t, Vector4f res[], size_t count);
+
+void vec_fma4fArray(const Vector4f a[], const Vector4f b[], const Vector4f c[], Vector4f res[], size_t count);
+
+void vec_pad3fArray(const Vector3f v[], Vector3fPadded res[], size_t count);
+
+void vec_unpad3fArray(const Vector3fPadded v[], Vector3f res[], size_t count);
+
+#ifdef MATH_INLINE
+#include "vector_inline.h"
+#endif
+
 #endif //VECTOR_H
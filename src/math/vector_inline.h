@@ -0,0 +1,356 @@
+#ifndef VECTOR_INLINE_H
+#define VECTOR_INLINE_H
+
+#include <math.h>
+
+#include "vector.h"
+
+#ifdef __FMA__
+#include <immintrin.h>
+#endif
+
+#ifdef __SSE2__
+static inline __m128 vecSseHorizontalSum(const __m128 v) {
+    const __m128 pairs = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+#endif
+
+static inline float vecInverseLength(const float squaredLength) {
+    return squaredLength > 0.0f ? 1.0f / sqrtf(squaredLength) : 0.0f;
+}
+
+static inline float vecMin(const float a, const float b) {
+    return a < b ? a : b;
+}
+
+static inline float vecMax(const float a, const float b) {
+    return a > b ? a : b;
+}
+
+MATH_API void vec_add2f(const Vector2f *const a, const Vector2f *const b, Vector2f *const res) {
+    res->x = a->x + b->x;
+    res->y = a->y + b->y;
+}
+
+MATH_API void vec_sub2f(const Vector2f *const a, const Vector2f *const b, Vector2f *const res) {
+    res->x = a->x - b->x;
+    res->y = a->y - b->y;
+}
+
+MATH_API void vec_multNum2f(const Vector2f *const v, const float n, Vector2f *const res) {
+    res->x = v->x * n;
+    res->y = v->y * n;
+}
+
+MATH_API float vec_dot2f(const Vector2f *const a, const Vector2f *const b) {
+    return a->x * b->x + a->y * b->y;
+}
+
+MATH_API float vec_cross2f(const Vector2f *const a, const Vector2f *const b) {
+    return a->x * b->y - a->y * b->x;
+}
+
+MATH_API float vec_length2f(const Vector2f *const v) {
+    return sqrtf(vec_dot2f(v, v));
+}
+
+MATH_API void vec_normalize2f(const Vector2f *const v, Vector2f *const res) {
+    vec_multNum2f(v, vecInverseLength(vec_dot2f(v, v)), res);
+}
+
+MATH_API void vec_min2f(const Vector2f *const a, const Vector2f *const b, Vector2f *const res) {
+    res->x = vecMin(a->x, b->x);
+    res->y = vecMin(a->y, b->y);
+}
+
+MATH_API void vec_max2f(const Vector2f *const a, const Vector2f *const b, Vector2f *const res) {
+    res->x = vecMax(a->x, b->x);
+    res->y = vecMax(a->y, b->y);
+}
+
+MATH_API void vec_lerp2f(const Vector2f *const a, const Vector2f *const b, const float t, Vector2f *const res) {
+    res->x = a->x + (b->x - a->x) * t;
+    res->y = a->y + (b->y - a->y) * t;
+}
+
+MATH_API void vec_fma2f(const Vector2f *const a, const Vector2f *const b, const Vector2f *const c,
+                        Vector2f *const res) {
+    res->x = a->x * b->x + c->x;
+    res->y = a->y * b->y + c->y;
+}
+
+MATH_API void vec_add3f(const Vector3f *const a, const Vector3f *const b, Vector3f *const res) {
+    res->x = a->x + b->x;
+    res->y = a->y + b->y;
+    res->z = a->z + b->z;
+}
+
+MATH_API void vec_sub3f(const Vector3f *const a, const Vector3f *const b, Vector3f *const res) {
+    res->x = a->x - b->x;
+    res->y = a->y - b->y;
+    res->z = a->z - b->z;
+}
+
+MATH_API void vec_multNum3f(const Vector3f *const v, const float n, Vector3f *const res) {
+    res->x = v->x * n;
+    res->y = v->y * n;
+    res->z = v->z * n;
+}
+
+MATH_API float vec_dot3f(const Vector3f *const a, const Vector3f *const b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z;
+}
+
+MATH_API void vec_cross3f(const Vector3f *const a, const Vector3f *const b, Vector3f *const res) {
+    const Vector3f cross = {
+        a->y * b->z - a->z * b->y,
+        a->z * b->x - a->x * b->z,
+        a->x * b->y - a->y * b->x,
+    };
+    *res = cross;
+}
+
+MATH_API float vec_length3f(const Vector3f *const v) {
+    return sqrtf(vec_dot3f(v, v));
+}
+
+MATH_API void vec_normalize3f(const Vector3f *const v, Vector3f *const res) {
+    vec_multNum3f(v, vecInverseLength(vec_dot3f(v, v)), res);
+}
+
+MATH_API void vec_min3f(const Vector3f *const a, const Vector3f *const b, Vector3f *const res) {
+    res->x = vecMin(a->x, b->x);
+    res->y = vecMin(a->y, b->y);
+    res->z = vecMin(a->z, b->z);
+}
+
+MATH_API void vec_max3f(const Vector3f *const a, const Vector3f *const b, Vector3f *const res) {
+    res->x = vecMax(a->x, b->x);
+    res->y = vecMax(a->y, b->y);
+    res->z = vecMax(a->z, b->z);
+}
+
+MATH_API void vec_lerp3f(const Vector3f *const a, const Vector3f *const b, const float t, Vector3f *const res) {
+    res->x = a->x + (b->x - a->x) * t;
+    res->y = a->y + (b->y - a->y) * t;
+    res->z = a->z + (b->z - a->z) * t;
+}
+
+MATH_API void vec_fma3f(const Vector3f *const a, const Vector3f *const b, const Vector3f *const c,
+                        Vector3f *const res) {
+    res->x = a->x * b->x + c->x;
+    res->y = a->y * b->y + c->y;
+    res->z = a->z * b->z + c->z;
+}
+
+MATH_API void vec_add4f(const Vector4f *const a, const Vector4f *const b, Vector4f *const res) {
+    res->x = a->x + b->x;
+    res->y = a->y + b->y;
+    res->z = a->z + b->z;
+    res->w = a->w + b->w;
+}
+
+MATH_API void vec_sub4f(const Vector4f *const a, const Vector4f *const b, Vector4f *const res) {
+    res->x = a->x - b->x;
+    res->y = a->y - b->y;
+    res->z = a->z - b->z;
+    res->w = a->w - b->w;
+}
+
+MATH_API void vec_multNum4f(const Vector4f *const v, const float n, Vector4f *const res) {
+    res->x = v->x * n;
+    res->y = v->y * n;
+    res->z = v->z * n;
+    res->w = v->w * n;
+}
+
+MATH_API float vec_dot4f(const Vector4f *const a, const Vector4f *const b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+MATH_API float vec_length4f(const Vector4f *const v) {
+    return sqrtf(vec_dot4f(v, v));
+}
+
+MATH_API void vec_normalize4f(const Vector4f *const v, Vector4f *const res) {
+    vec_multNum4f(v, vecInverseLength(vec_dot4f(v, v)), res);
+}
+
+MATH_API void vec_min4f(const Vector4f *const a, const Vector4f *const b, Vector4f *const res) {
+    res->x = vecMin(a->x, b->x);
+    res->y = vecMin(a->y, b->y);
+    res->z = vecMin(a->z, b->z);
+    res->w = vecMin(a->w, b->w);
+}
+
+MATH_API void vec_max4f(const Vector4f *const a, const Vector4f *const b, Vector4f *const res) {
+    res->x = vecMax(a->x, b->x);
+    res->y = vecMax(a->y, b->y);
+    res->z = vecMax(a->z, b->z);
+    res->w = vecMax(a->w, b->w);
+}
+
+MATH_API void vec_lerp4f(const Vector4f *const a, const Vector4f *const b, const float t, Vector4f *const res) {
+    res->x = a->x + (b->x - a->x) * t;
+    res->y = a->y + (b->y - a->y) * t;
+    res->z = a->z + (b->z - a->z) * t;
+    res->w = a->w + (b->w - a->w) * t;
+}
+
+MATH_API void vec_fma4f(const Vector4f *const a, const Vector4f *const b, const Vector4f *const c,
+                        Vector4f *const res) {
+    res->x = a->x * b->x + c->x;
+    res->y = a->y * b->y + c->y;
+    res->z = a->z * b->z + c->z;
+    res->w = a->w * b->w + c->w;
+}
+
+MATH_API void vec_pad3f(const Vector3f *const v, Vector3fPadded *const res) {
+    res->x = v->x;
+    res->y = v->y;
+    res->z = v->z;
+    res->_pad = 0.0f;
+}
+
+MATH_API void vec_unpad3f(const Vector3fPadded *const v, Vector3f *const res) {
+    res->x = v->x;
+    res->y = v->y;
+    res->z = v->z;
+}
+
+#ifdef __SSE2__
+MATH_API void vec_add3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    res->m = _mm_add_ps(a->m, b->m);
+}
+
+MATH_API void vec_sub3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    res->m = _mm_sub_ps(a->m, b->m);
+}
+
+MATH_API void vec_multNum3fp(const Vector3fPadded *const v, const float n, Vector3fPadded *const res) {
+    res->m = _mm_mul_ps(v->m, _mm_set1_ps(n));
+}
+
+MATH_API float vec_dot3fp(const Vector3fPadded *const a, const Vector3fPadded *const b) {
+    return _mm_cvtss_f32(vecSseHorizontalSum(_mm_mul_ps(a->m, b->m)));
+}
+
+MATH_API void vec_cross3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    // a * b.yzx - a.yzx * b gives the cross product in zxy order, the padding lanes cancel out
+    const __m128 aYzx = _mm_shuffle_ps(a->m, a->m, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 bYzx = _mm_shuffle_ps(b->m, b->m, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 zxy = _mm_sub_ps(_mm_mul_ps(a->m, bYzx), _mm_mul_ps(aYzx, b->m));
+    res->m = _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+MATH_API void vec_normalize3fp(const Vector3fPadded *const v, Vector3fPadded *const res) {
+    const __m128 squaredLength = vecSseHorizontalSum(_mm_mul_ps(v->m, v->m));
+    const __m128 isNonZero = _mm_cmpgt_ps(squaredLength, _mm_setzero_ps());
+    res->m = _mm_and_ps(_mm_div_ps(v->m, _mm_sqrt_ps(squaredLength)), isNonZero);
+}
+
+MATH_API void vec_min3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    res->m = _mm_min_ps(a->m, b->m);
+}
+
+MATH_API void vec_max3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    res->m = _mm_max_ps(a->m, b->m);
+}
+
+MATH_API void vec_lerp3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, const float t,
+                          Vector3fPadded *const res) {
+    res->m = _mm_add_ps(a->m, _mm_mul_ps(_mm_sub_ps(b->m, a->m), _mm_set1_ps(t)));
+}
+
+MATH_API void vec_fma3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, const Vector3fPadded *const c,
+                         Vector3fPadded *const res) {
+#ifdef __FMA__
+    res->m = _mm_fmadd_ps(a->m, b->m, c->m);
+#else
+    res->m = _mm_add_ps(_mm_mul_ps(a->m, b->m), c->m);
+#endif
+}
+#else
+// Without SSE the padded layout goes through the Vector3f code on copies, the padding stays zero
+static inline Vector3f vecUnpadded(const Vector3fPadded *const v) {
+    return (Vector3f) {v->x, v->y, v->z};
+}
+
+static inline void vecStorePadded(const Vector3f *const v, Vector3fPadded *const res) {
+    res->x = v->x;
+    res->y = v->y;
+    res->z = v->z;
+    res->_pad = 0.0f;
+}
+
+MATH_API void vec_add3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    Vector3f v;
+    vec_add3f(&l, &r, &v);
+    vecStorePadded(&v, res);
+}
+
+MATH_API void vec_sub3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    Vector3f v;
+    vec_sub3f(&l, &r, &v);
+    vecStorePadded(&v, res);
+}
+
+MATH_API void vec_multNum3fp(const Vector3fPadded *const v, const float n, Vector3fPadded *const res) {
+    Vector3f u = vecUnpadded(v);
+    vec_multNum3f(&u, n, &u);
+    vecStorePadded(&u, res);
+}
+
+MATH_API float vec_dot3fp(const Vector3fPadded *const a, const Vector3fPadded *const b) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    return vec_dot3f(&l, &r);
+}
+
+MATH_API void vec_cross3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    Vector3f v;
+    vec_cross3f(&l, &r, &v);
+    vecStorePadded(&v, res);
+}
+
+MATH_API void vec_normalize3fp(const Vector3fPadded *const v, Vector3fPadded *const res) {
+    Vector3f u = vecUnpadded(v);
+    vec_normalize3f(&u, &u);
+    vecStorePadded(&u, res);
+}
+
+MATH_API void vec_min3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    Vector3f v;
+    vec_min3f(&l, &r, &v);
+    vecStorePadded(&v, res);
+}
+
+MATH_API void vec_max3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    Vector3f v;
+    vec_max3f(&l, &r, &v);
+    vecStorePadded(&v, res);
+}
+
+MATH_API void vec_lerp3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, const float t,
+                          Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b);
+    Vector3f v;
+    vec_lerp3f(&l, &r, t, &v);
+    vecStorePadded(&v, res);
+}
+
+MATH_API void vec_fma3fp(const Vector3fPadded *const a, const Vector3fPadded *const b, const Vector3fPadded *const c,
+                         Vector3fPadded *const res) {
+    const Vector3f l = vecUnpadded(a), r = vecUnpadded(b), addend = vecUnpadded(c);
+    Vector3f v;
+    vec_fma3f(&l, &r, &addend, &v);
+    vecStorePadded(&v, res);
+}
+#endif
+
+#endif //VECTOR_INLINE_H
@@ -0,0 +1,196 @@
+#include "mesh.h"
+
+#include <stdlib.h>
+
+#include "glstate.h"
+
+// Vertex buffer binding points when attribute formats are separate from buffers
+#define MESH_BINDING 0
+#define INSTANCE_MODEL_BINDING 1
+#define INSTANCE_COLOR_BINDING 2
+
+static const struct {
+    MeshAttributes attribute;
+    GLuint location;
+    GLint size;
+} meshAttributes[] = {
+    {MESH_POSITION, 0, 3},
+    {MESH_COLOR, 1, 3},
+    {MESH_NORMAL, 2, 3},
+    {MESH_UV, 3, 2},
+};
+
+#define MESH_ATTRIBUTE_COUNT (sizeof(meshAttributes) / sizeof(meshAttributes[0]))
+
+size_t mesh_getVertexFloats(const MeshAttributes attributes) {
+    size_t floats = 0;
+    for (size_t i = 0; i < MESH_ATTRIBUTE_COUNT; i++) {
+        if (attributes & meshAttributes[i].attribute) floats += meshAttributes[i].size;
+    }
+    return floats;
+}
+
+void mesh_interleave(const MeshAttributes attributes, const float positions[], const float colors[],
+                     const float normals[], const float uvs[], const size_t count, float res[]) {
+    const float *const sources[] = {positions, colors, normals, uvs};
+    const size_t vertexFloats = mesh_getVertexFloats(attributes);
+    size_t offset = 0;
+    for (size_t a = 0; a < MESH_ATTRIBUTE_COUNT; a++) {
+        if (!(attributes & meshAttributes[a].attribute)) continue;
+        const size_t size = meshAttributes[a].size;
+        for (size_t v = 0; v < count; v++) {
+            for (size_t c = 0; c < size; c++) res[v * vertexFloats + offset + c] = sources[a][v * size + c];
+        }
+        offset += size;
+    }
+}
+
+/**
+ * Points the bound vertex array at the vertex and index buffers of the mesh.
+ */
+static void setupVertexArray(const Mesh *const mesh) {
+    gls_bindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    if (mesh->ebo != 0) gls_bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+    if (GLAD_GL_VERSION_4_3) glBindVertexBuffer(MESH_BINDING, mesh->vbo, 0, mesh->stride);
+    GLuint offset = 0;
+    for (size_t i = 0; i < MESH_ATTRIBUTE_COUNT; i++) {
+        if (!(mesh->attributes & meshAttributes[i].attribute)) continue;
+        const GLuint location = meshAttributes[i].location;
+        glEnableVertexAttribArray(location);
+        if (GLAD_GL_VERSION_4_3) {
+            glVertexAttribFormat(location, meshAttributes[i].size, GL_FLOAT, GL_FALSE, offset);
+            glVertexAttribBinding(location, MESH_BINDING);
+        } else {
+            glVertexAttribPointer(location, meshAttributes[i].size, GL_FLOAT, GL_FALSE, mesh->stride,
+                                  (const void *) (size_t) offset);
+        }
+        offset += meshAttributes[i].size * sizeof(float);
+    }
+}
+
+Mesh *mesh_upload(const MeshAttributes attributes, const float vertices[], const size_t count) {
+    return mesh_uploadIndexed(attributes, vertices, count, NULL, 0);
+}
+
+Mesh *mesh_uploadIndexed(const MeshAttributes attributes, const float vertices[], const size_t count,
+                         const uint32_t indices[], const size_t indexCount) {
+    Mesh *mesh = malloc(sizeof(Mesh));
+    mesh->attributes = attributes;
+    mesh->vertexCount = (GLsizei) count;
+    mesh->indexCount = (GLsizei) indexCount;
+    mesh->ebo = 0;
+    mesh->stride = (GLsizei) (mesh_getVertexFloats(attributes) * sizeof(float));
+
+    glGenVertexArrays(1, &mesh->vao);
+    gls_bindVertexArray(mesh->vao);
+    glGenBuffers(1, &mesh->vbo);
+    gls_bindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) count * mesh->stride, vertices, GL_STATIC_DRAW);
+
+    if (indices != NULL) {
+        glGenBuffers(1, &mesh->ebo);
+        gls_bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) (indexCount * sizeof(uint32_t)), indices, GL_STATIC_DRAW);
+    }
+    setupVertexArray(mesh);
+
+    gls_bindVertexArray(0);
+    return mesh;
+}
+
+void mesh_draw(const Mesh *const mesh) {
+    gls_bindVertexArray(mesh->vao);
+    mesh_drawBound(mesh);
+}
+
+void mesh_drawBound(const Mesh *const mesh) {
+    if (mesh->ebo != 0) {
+        glDrawElements(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, NULL);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, mesh->vertexCount);
+    }
+}
+
+void mesh_dispose(Mesh *mesh) {
+    gls_deleteVertexArrays(1, &mesh->vao);
+    gls_deleteBuffers(1, &mesh->vbo);
+    if (mesh->ebo != 0) gls_deleteBuffers(1, &mesh->ebo);
+    free(mesh);
+}
+
+MeshInstances *mesh_createInstances(const Mesh *const mesh, const size_t capacity) {
+    MeshInstances *instances = malloc(sizeof(MeshInstances));
+    instances->mesh = mesh;
+    instances->count = 0;
+    instances->capacity = capacity;
+
+    glGenVertexArrays(1, &instances->vao);
+    gls_bindVertexArray(instances->vao);
+    setupVertexArray(mesh);
+
+    // Models fill the front of the buffer and colors the rest, so both upload straight from the caller's arrays
+    const GLintptr colorOffset = (GLintptr) (capacity * sizeof(Matrix4f));
+    glGenBuffers(1, &instances->buffer);
+    gls_bindBuffer(GL_ARRAY_BUFFER, instances->buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (capacity * (sizeof(Matrix4f) + sizeof(Vector3f))), NULL,
+                 GL_DYNAMIC_DRAW);
+    if (GLAD_GL_VERSION_4_3) {
+        glBindVertexBuffer(INSTANCE_MODEL_BINDING, instances->buffer, 0, sizeof(Matrix4f));
+        glVertexBindingDivisor(INSTANCE_MODEL_BINDING, 1);
+        glBindVertexBuffer(INSTANCE_COLOR_BINDING, instances->buffer, colorOffset, sizeof(Vector3f));
+        glVertexBindingDivisor(INSTANCE_COLOR_BINDING, 1);
+    }
+    for (GLuint column = 0; column < 4; column++) {
+        const GLuint location = MESH_INSTANCE_MODEL_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        if (GLAD_GL_VERSION_4_3) {
+            glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE, column * 4 * sizeof(float));
+            glVertexAttribBinding(location, INSTANCE_MODEL_BINDING);
+        } else {
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4f),
+                                  (const void *) (column * 4 * sizeof(float)));
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+    glEnableVertexAttribArray(MESH_INSTANCE_COLOR_LOCATION);
+    if (GLAD_GL_VERSION_4_3) {
+        glVertexAttribFormat(MESH_INSTANCE_COLOR_LOCATION, 3, GL_FLOAT, GL_FALSE, 0);
+        glVertexAttribBinding(MESH_INSTANCE_COLOR_LOCATION, INSTANCE_COLOR_BINDING);
+    } else {
+        glVertexAttribPointer(MESH_INSTANCE_COLOR_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(Vector3f),
+                              (const void *) colorOffset);
+        glVertexAttribDivisor(MESH_INSTANCE_COLOR_LOCATION, 1);
+    }
+
+    gls_bindVertexArray(0);
+    return instances;
+}
+
+void mesh_setInstances(MeshInstances *const instances, const Matrix4f models[], const Vector3f colors[],
+                       const size_t count) {
+    instances->count = count < instances->capacity ? count : instances->capacity;
+    gls_bindBuffer(GL_ARRAY_BUFFER, instances->buffer);
+    // Orphaning lets the driver hand out fresh storage instead of waiting for draws still reading the old one
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (instances->capacity * (sizeof(Matrix4f) + sizeof(Vector3f))), NULL,
+                 GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) (instances->count * sizeof(Matrix4f)), models);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (instances->capacity * sizeof(Matrix4f)),
+                    (GLsizeiptr) (instances->count * sizeof(Vector3f)), colors);
+}
+
+void mesh_drawInstances(const MeshInstances *const instances) {
+    if (instances->count == 0) return;
+    const Mesh *const mesh = instances->mesh;
+    gls_bindVertexArray(instances->vao);
+    if (mesh->ebo != 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, NULL, (GLsizei) instances->count);
+    } else {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, mesh->vertexCount, (GLsizei) instances->count);
+    }
+}
+
+void mesh_disposeInstances(MeshInstances *instances) {
+    gls_deleteVertexArrays(1, &instances->vao);
+    gls_deleteBuffers(1, &instances->buffer);
+    free(instances);
+}
@@ -0,0 +1,93 @@
+#ifndef MESH_H
+#define MESH_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glad/glad.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+
+/**
+ * Locations of the per-instance attributes: the model matrix takes four consecutive locations, one per column.
+ */
+#define MESH_INSTANCE_MODEL_LOCATION 4
+#define MESH_INSTANCE_COLOR_LOCATION 8
+
+/**
+ * Vertex attributes a mesh can have. Each one is read by shaders from a fixed location: position from 0, color from
+ * 1, normal from 2 and uv from 3. They are interleaved in this order, as floats.
+ */
+typedef enum {
+    MESH_POSITION = 1 << 0,
+    MESH_COLOR = 1 << 1,
+    MESH_NORMAL = 1 << 2,
+    MESH_UV = 1 << 3,
+} MeshAttributes;
+
+/**
+ * Vertices in one interleaved buffer, with a vertex array object that is configured once on upload.
+ * Indexed meshes keep their 32-bit triangle list in ebo, which the vertex array references; ebo is 0 otherwise.
+ */
+typedef struct {
+    GLuint vao, vbo, ebo;
+    GLsizei vertexCount;
+    GLsizei indexCount;
+    GLsizei stride;
+    MeshAttributes attributes;
+} Mesh;
+
+/**
+ * Copies of a mesh drawn with a single instanced call. Each copy has a model matrix and a color, read by shaders from
+ * MESH_INSTANCE_MODEL_LOCATION and MESH_INSTANCE_COLOR_LOCATION.
+ */
+typedef struct {
+    const Mesh *mesh;
+    GLuint vao, buffer;
+    size_t count, capacity;
+} MeshInstances;
+
+size_t mesh_getVertexFloats(MeshAttributes attributes);
+
+/**
+ * Interleaves separate attribute arrays into res, which needs room for count * mesh_getVertexFloats(attributes)
+ * floats. Arrays of attributes the mesh does not have are ignored and may be NULL.
+ */
+void mesh_interleave(MeshAttributes attributes, const float positions[], const float colors[], const float normals[],
+                     const float uvs[], size_t count, float res[]);
+
+/**
+ * Uploads interleaved vertices and sets up the vertex array. Uses separate attribute formats and vertex buffer bindings
+ * when the context supports OpenGL 4.3, attribute pointers otherwise.
+ */
+Mesh *mesh_upload(MeshAttributes attributes, const float vertices[], size_t count);
+
+/**
+ * mesh_upload for an indexed triangle list.
+ */
+Mesh *mesh_uploadIndexed(MeshAttributes attributes, const float vertices[], size_t count, const uint32_t indices[],
+                         size_t indexCount);
+
+void mesh_draw(const Mesh *mesh);
+
+/**
+ * mesh_draw for when the mesh's vertex array is already bound.
+ */
+void mesh_drawBound(const Mesh *mesh);
+
+void mesh_dispose(Mesh *mesh);
+
+/**
+ * Creates room for capacity instances of mesh. The mesh must outlive them.
+ */
+MeshInstances *mesh_createInstances(const Mesh *mesh, size_t capacity);
+
+/**
+ * Replaces the instances with count models and colors, past the capacity they are dropped.
+ */
+void mesh_setInstances(MeshInstances *instances, const Matrix4f models[], const Vector3f colors[], size_t count);
+
+void mesh_drawInstances(const MeshInstances *instances);
+
+void mesh_disposeInstances(MeshInstances *instances);
+
+#endif //MESH_H
@@ -0,0 +1,144 @@
+#include "programcache.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "utility/log.h"
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+// Spells DPRG in the first bytes of every cache file
+#define CACHE_MAGIC 0x47525044u
+
+const char *programCacheDirectory = ".shadercache/";
+
+typedef struct {
+    uint32_t magic;
+    uint32_t format;
+    uint64_t key;
+    uint64_t length;
+} CacheHeader;
+
+__attribute__ ((format(printf, 2, 3)))
+static void llog(const char *const level, char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    glog(level, format, "programcache", args);
+    va_end(args);
+}
+
+static uint64_t hashBytes(uint64_t hash, const void *const bytes, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= ((const unsigned char *) bytes)[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Hashes the string with its terminator, so consecutive strings cannot run into each other.
+ */
+static uint64_t hashString(const uint64_t hash, const char *const string) {
+    return hashBytes(hash, string, strlen(string) + 1);
+}
+
+static void getPath(const uint64_t key, char *const res, const size_t size) {
+    snprintf(res, size, "%s%016" PRIx64 ".bin", programCacheDirectory, key);
+}
+
+bool pcache_isAvailable() {
+    if (programCacheDirectory == NULL || !GLAD_GL_VERSION_4_1) return false;
+    GLint formatCount;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+uint64_t pcache_getKey(const Shader shaders[], const size_t count) {
+    uint64_t hash = FNV_OFFSET;
+    hash = hashString(hash, (const char *) glGetString(GL_VENDOR));
+    hash = hashString(hash, (const char *) glGetString(GL_RENDERER));
+    hash = hashString(hash, (const char *) glGetString(GL_VERSION));
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t type = shaders[i].type;
+        hash = hashBytes(hash, &type, sizeof(type));
+        hash = hashString(hash, shaders[i].source);
+    }
+    return hash;
+}
+
+GLuint pcache_load(const uint64_t key) {
+    const size_t pathLength = strlen(programCacheDirectory) + 21;
+    char path[pathLength];
+    getPath(key, path, pathLength);
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return 0;
+
+    CacheHeader header;
+    void *binary = NULL;
+    bool isRead = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CACHE_MAGIC &&
+                  header.key == key && header.length > 0 && header.length <= INT32_MAX;
+    if (isRead) {
+        binary = malloc(header.length);
+        isRead = fread(binary, 1, header.length, file) == header.length;
+    }
+    fclose(file);
+    if (!isRead) {
+        llog(INFO, "Ignoring a damaged cache file: %s", path);
+        free(binary);
+        return 0;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary, (GLsizei) header.length);
+    free(binary);
+    GLint isLinked;
+    glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+    if (isLinked == GL_FALSE) {
+        // Drivers reject binaries saved by other builds of themselves even when the version string is the same
+        llog(INFO, "The driver rejected the cached binary %s, compiling from source", path);
+        glDeleteProgram(program);
+        return 0;
+    }
+    llog(INFO, "Loaded the program from %s", path);
+    return program;
+}
+
+void pcache_save(const uint64_t key, const GLuint program) {
+    GLint length;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    void *binary = malloc(length);
+    GLenum format;
+    glGetProgramBinary(program, length, NULL, &format, binary);
+
+    if (mkdir(programCacheDirectory, 0755) != 0 && errno != EEXIST) {
+        llog(ERROR, "Cannot create the program cache directory. %s: %s", strerror(errno), programCacheDirectory);
+        free(binary);
+        return;
+    }
+    const size_t pathLength = strlen(programCacheDirectory) + 21;
+    char path[pathLength];
+    getPath(key, path, pathLength);
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        llog(ERROR, "Cannot write to the program cache. %s: %s", strerror(errno), path);
+        free(binary);
+        return;
+    }
+    const CacheHeader header = {CACHE_MAGIC, format, key, (uint64_t) length};
+    const bool isWritten = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                           fwrite(binary, 1, length, file) == (size_t) length;
+    fclose(file);
+    free(binary);
+    if (!isWritten) {
+        llog(ERROR, "Failed to write the program cache file %s", path);
+        remove(path);
+        return;
+    }
+    llog(INFO, "Saved the program to %s", path);
+}
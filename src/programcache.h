@@ -0,0 +1,38 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glad/glad.h"
+#include "shader.h"
+
+/**
+ * Where linked program binaries are kept, relative to the working directory. NULL turns the cache off.
+ */
+extern const char *programCacheDirectory;
+
+/**
+ * Whether the cache is on and the driver can save and load program binaries, which needs OpenGL 4.1 and at least
+ * one binary format.
+ */
+bool pcache_isAvailable();
+
+/**
+ * Hash of the shaders' stages and sources and of the driver's GL_VENDOR, GL_RENDERER and GL_VERSION, so a binary is
+ * never loaded by a driver other than the one that saved it.
+ */
+uint64_t pcache_getKey(const Shader shaders[], size_t count);
+
+/**
+ * Creates a program from the binary saved for key. Returns 0 if there is none or the driver rejects it as stale.
+ */
+GLuint pcache_load(uint64_t key);
+
+/**
+ * Saves the binary of a linked program under key. The program must have been linked with
+ * GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+ */
+void pcache_save(uint64_t key, GLuint program);
+
+#endif //PROGRAMCACHE_H
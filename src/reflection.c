@@ -0,0 +1,339 @@
+#include "reflection.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utility/log.h"
+
+#define FNV_OFFSET 0xCBF29CE484222325
+#define FNV_PRIME 0x100000001B3
+
+__attribute__ ((format(printf, 2, 3)))
+static void llog(const char *const level, char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    glog(level, format, "reflection", args);
+    va_end(args);
+}
+
+static uint64_t hashName(const ReflectionKind kind, const char *name) {
+    // Uniforms and blocks have separate namespaces, so the kind is part of the key
+    uint64_t hash = (FNV_OFFSET ^ kind) * FNV_PRIME;
+    for (; *name != '\0'; name++) hash = (hash ^ (unsigned char) *name) * FNV_PRIME;
+    return hash;
+}
+
+/**
+ * Whether the type is a sampler or an image, which are set like ints to the unit they read from.
+ */
+static bool isOpaqueType(const GLenum type) {
+    switch (type) {
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_1D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT:
+        case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+        case GL_INT_SAMPLER_1D:
+        case GL_INT_SAMPLER_2D:
+        case GL_INT_SAMPLER_3D:
+        case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY:
+        case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D_RECT:
+        case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_1D:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+        case GL_IMAGE_1D:
+        case GL_IMAGE_2D:
+        case GL_IMAGE_3D:
+        case GL_IMAGE_2D_RECT:
+        case GL_IMAGE_CUBE:
+        case GL_IMAGE_BUFFER:
+        case GL_IMAGE_1D_ARRAY:
+        case GL_IMAGE_2D_ARRAY:
+        case GL_IMAGE_CUBE_MAP_ARRAY:
+        case GL_IMAGE_2D_MULTISAMPLE:
+        case GL_IMAGE_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_IMAGE_1D:
+        case GL_INT_IMAGE_2D:
+        case GL_INT_IMAGE_3D:
+        case GL_INT_IMAGE_2D_RECT:
+        case GL_INT_IMAGE_CUBE:
+        case GL_INT_IMAGE_BUFFER:
+        case GL_INT_IMAGE_1D_ARRAY:
+        case GL_INT_IMAGE_2D_ARRAY:
+        case GL_INT_IMAGE_CUBE_MAP_ARRAY:
+        case GL_INT_IMAGE_2D_MULTISAMPLE:
+        case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_1D:
+        case GL_UNSIGNED_INT_IMAGE_2D:
+        case GL_UNSIGNED_INT_IMAGE_3D:
+        case GL_UNSIGNED_INT_IMAGE_2D_RECT:
+        case GL_UNSIGNED_INT_IMAGE_CUBE:
+        case GL_UNSIGNED_INT_IMAGE_BUFFER:
+        case GL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+        case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Whether refl_setInt can set a uniform of the type.
+ */
+static bool isIntType(const GLenum type) {
+    return type == GL_INT || type == GL_BOOL || isOpaqueType(type);
+}
+
+/**
+ * Bytes the last value of a uniform of the type takes, 0 for types no setter handles.
+ */
+static size_t getValueSize(const GLenum type) {
+    switch (type) {
+        case GL_FLOAT:
+            return sizeof(GLfloat);
+        case GL_FLOAT_VEC3:
+            return sizeof(GLfloat[3]);
+        case GL_FLOAT_VEC4:
+            return sizeof(GLfloat[4]);
+        case GL_FLOAT_MAT4:
+            return sizeof(GLfloat[4][4]);
+        default:
+            return isIntType(type) ? sizeof(GLint) : 0;
+    }
+}
+
+static void addResource(ProgramReflection *const r, size_t *const capacity, const ReflectionKind kind, char *name,
+                        const GLenum type, const GLint location, const GLint arraySize, const GLint binding,
+                        const GLint dataSize) {
+    const size_t nameLength = strlen(name);
+    if (nameLength > 3 && strcmp(name + nameLength - 3, "[0]") == 0) name[nameLength - 3] = '\0';
+    if (r->count == *capacity) {
+        *capacity = *capacity > 0 ? 2 * *capacity : 8;
+        r->resources = realloc(r->resources, *capacity * sizeof(ProgramResource));
+    }
+    ProgramResource *const res = r->resources + r->count++;
+    res->name = malloc(strlen(name) + 1);
+    strcpy(res->name, name);
+    res->kind = kind;
+    res->type = type;
+    res->location = location;
+    res->arraySize = arraySize;
+    res->binding = binding;
+    res->dataSize = dataSize;
+    res->_hash = hashName(kind, res->name);
+    res->_valueOffset = 0;
+    res->_isValueKnown = false;
+}
+
+/**
+ * Blocks through the program interface queries, which also list storage blocks.
+ */
+static void addBlocks(ProgramReflection *const r, size_t *const capacity, const GLenum interface,
+                      const ReflectionKind kind) {
+    GLint count, maxNameLength;
+    glGetProgramInterfaceiv(r->program, interface, GL_ACTIVE_RESOURCES, &count);
+    glGetProgramInterfaceiv(r->program, interface, GL_MAX_NAME_LENGTH, &maxNameLength);
+    char name[maxNameLength + 1];
+    const GLenum properties[] = {GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+    for (GLint i = 0; i < count; i++) {
+        GLint values[2];
+        glGetProgramResourceiv(r->program, interface, i, 2, properties, 2, NULL, values);
+        glGetProgramResourceName(r->program, interface, i, maxNameLength + 1, NULL, name);
+        addResource(r, capacity, kind, name, GL_NONE, i, 1, values[0], values[1]);
+    }
+}
+
+static void addResources(ProgramReflection *const r, size_t *const capacity) {
+    GLint count, maxNameLength;
+    glGetProgramInterfaceiv(r->program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+    glGetProgramInterfaceiv(r->program, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+    char name[maxNameLength + 1];
+    const GLenum properties[] = {GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX};
+    for (GLint i = 0; i < count; i++) {
+        GLint values[4];
+        glGetProgramResourceiv(r->program, GL_UNIFORM, i, 4, properties, 4, NULL, values);
+        if (values[3] != -1) continue;
+        glGetProgramResourceName(r->program, GL_UNIFORM, i, maxNameLength + 1, NULL, name);
+        addResource(r, capacity, REFL_UNIFORM, name, values[0], values[1], values[2], -1, 0);
+    }
+    addBlocks(r, capacity, GL_UNIFORM_BLOCK, REFL_UNIFORM_BLOCK);
+    addBlocks(r, capacity, GL_SHADER_STORAGE_BLOCK, REFL_STORAGE_BLOCK);
+}
+
+/**
+ * Uniforms and uniform blocks through the older queries, the only ones before OpenGL 4.3.
+ */
+static void addResourcesLegacy(ProgramReflection *const r, size_t *const capacity) {
+    GLint count, maxNameLength;
+    glGetProgramiv(r->program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(r->program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    char name[maxNameLength + 1];
+    for (GLuint i = 0; i < (GLuint) count; i++) {
+        GLint blockIndex, arraySize;
+        GLenum type;
+        glGetActiveUniformsiv(r->program, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        if (blockIndex != -1) continue;
+        glGetActiveUniform(r->program, i, maxNameLength + 1, NULL, &arraySize, &type, name);
+        addResource(r, capacity, REFL_UNIFORM, name, type, glGetUniformLocation(r->program, name), arraySize, -1, 0);
+    }
+
+    glGetProgramiv(r->program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(r->program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+    char blockName[maxNameLength + 1];
+    for (GLuint i = 0; i < (GLuint) count; i++) {
+        GLint binding, dataSize;
+        glGetActiveUniformBlockiv(r->program, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+        glGetActiveUniformBlockiv(r->program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+        glGetActiveUniformBlockName(r->program, i, maxNameLength + 1, NULL, blockName);
+        addResource(r, capacity, REFL_UNIFORM_BLOCK, blockName, GL_NONE, (GLint) i, 1, binding, dataSize);
+    }
+}
+
+ProgramReflection *refl_build(const GLuint program) {
+    ProgramReflection *r = calloc(1, sizeof(ProgramReflection));
+    r->program = program;
+    size_t capacity = 0;
+    if (GLAD_GL_VERSION_4_3) addResources(r, &capacity);
+    else addResourcesLegacy(r, &capacity);
+
+    size_t valuesSize = 0;
+    for (size_t i = 0; i < r->count; i++) {
+        ProgramResource *const res = r->resources + i;
+        if (res->kind != REFL_UNIFORM) continue;
+        res->_valueOffset = valuesSize;
+        valuesSize += getValueSize(res->type);
+    }
+    r->_values = malloc(valuesSize > 0 ? valuesSize : 1);
+
+    // At most half full, so a miss ends at an empty slot after a probe or two
+    size_t tableSize = 8;
+    while (tableSize < 2 * r->count) tableSize *= 2;
+    r->_tableMask = tableSize - 1;
+    r->_table = malloc(tableSize * sizeof(int32_t));
+    memset(r->_table, 0xFF, tableSize * sizeof(int32_t));
+    for (size_t i = 0; i < r->count; i++) {
+        size_t slot = r->resources[i]._hash & r->_tableMask;
+        while (r->_table[slot] != -1) slot = (slot + 1) & r->_tableMask;
+        r->_table[slot] = (int32_t) i;
+    }
+    return r;
+}
+
+void refl_dispose(ProgramReflection *r) {
+    for (size_t i = 0; i < r->count; i++) free(r->resources[i].name);
+    free(r->resources);
+    free(r->_table);
+    free(r->_values);
+    free(r);
+}
+
+int32_t refl_find(const ProgramReflection *const r, const ReflectionKind kind, const char *const name) {
+    const uint64_t hash = hashName(kind, name);
+    for (size_t slot = hash & r->_tableMask; r->_table[slot] != -1; slot = (slot + 1) & r->_tableMask) {
+        const ProgramResource *const res = r->resources + r->_table[slot];
+        if (res->_hash == hash && res->kind == kind && strcmp(res->name, name) == 0) return r->_table[slot];
+    }
+    return -1;
+}
+
+void refl_setBlockBinding(ProgramReflection *const r, const int32_t block, const GLuint binding) {
+    if (block < 0) return;
+    ProgramResource *const res = r->resources + block;
+    if (res->binding == (GLint) binding) return;
+    res->binding = (GLint) binding;
+    if (res->kind == REFL_STORAGE_BLOCK) glShaderStorageBlockBinding(r->program, res->location, binding);
+    else glUniformBlockBinding(r->program, res->location, binding);
+}
+
+/**
+ * Checks the uniform's type and records value as its last one. Returns false if the value must not be uploaded,
+ * because the type is wrong or the uniform already has it.
+ */
+static bool updateValue(ProgramReflection *const r, const int32_t uniform, const bool isTypeRight,
+                        const void *const value, const size_t size) {
+    ProgramResource *const res = r->resources + uniform;
+    if (!isTypeRight || res->kind != REFL_UNIFORM) {
+        llog(ERROR, "Uniform %s of program %u is not of the type being set", res->name, r->program);
+        return false;
+    }
+    unsigned char *const last = r->_values + res->_valueOffset;
+    if (res->_isValueKnown && memcmp(last, value, size) == 0) {
+        r->skipped++;
+        return false;
+    }
+    memcpy(last, value, size);
+    res->_isValueKnown = true;
+    r->uploads++;
+    return true;
+}
+
+void refl_setInt(ProgramReflection *const r, const int32_t uniform, const GLint value) {
+    if (uniform < 0) return;
+    if (!updateValue(r, uniform, isIntType(r->resources[uniform].type), &value, sizeof(value))) return;
+    const GLint location = r->resources[uniform].location;
+    if (GLAD_GL_VERSION_4_1) glProgramUniform1i(r->program, location, value);
+    else glUniform1i(location, value);
+}
+
+void refl_setFloat(ProgramReflection *const r, const int32_t uniform, const GLfloat value) {
+    if (uniform < 0) return;
+    if (!updateValue(r, uniform, r->resources[uniform].type == GL_FLOAT, &value, sizeof(value))) return;
+    const GLint location = r->resources[uniform].location;
+    if (GLAD_GL_VERSION_4_1) glProgramUniform1f(r->program, location, value);
+    else glUniform1f(location, value);
+}
+
+void refl_setVec3(ProgramReflection *const r, const int32_t uniform, const Vector3f *const value) {
+    if (uniform < 0) return;
+    if (!updateValue(r, uniform, r->resources[uniform].type == GL_FLOAT_VEC3, value, sizeof(*value))) return;
+    const GLint location = r->resources[uniform].location;
+    if (GLAD_GL_VERSION_4_1) glProgramUniform3fv(r->program, location, 1, &value->x);
+    else glUniform3fv(location, 1, &value->x);
+}
+
+void refl_setVec4(ProgramReflection *const r, const int32_t uniform, const Vector4f *const value) {
+    if (uniform < 0) return;
+    if (!updateValue(r, uniform, r->resources[uniform].type == GL_FLOAT_VEC4, value, sizeof(*value))) return;
+    const GLint location = r->resources[uniform].location;
+    if (GLAD_GL_VERSION_4_1) glProgramUniform4fv(r->program, location, 1, &value->x);
+    else glUniform4fv(location, 1, &value->x);
+}
+
+void refl_setMat4(ProgramReflection *const r, const int32_t uniform, const Matrix4f *const value) {
+    if (uniform < 0) return;
+    if (!updateValue(r, uniform, r->resources[uniform].type == GL_FLOAT_MAT4, value->t, sizeof(value->t))) return;
+    const GLint location = r->resources[uniform].location;
+    if (GLAD_GL_VERSION_4_1) glProgramUniformMatrix4fv(r->program, location, 1, GL_FALSE, &value->t[0][0]);
+    else glUniformMatrix4fv(location, 1, GL_FALSE, &value->t[0][0]);
+}
@@ -0,0 +1,92 @@
+#ifndef REFLECTION_H
+#define REFLECTION_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glad/glad.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+
+typedef enum {
+    REFL_UNIFORM,
+    REFL_UNIFORM_BLOCK,
+    REFL_STORAGE_BLOCK,
+} ReflectionKind;
+
+/**
+ * An active uniform of the default block, a uniform block or a shader storage block. Names of arrays are stored
+ * without their [0].
+ */
+typedef struct {
+    char *name;
+    ReflectionKind kind;
+    /**
+     * GLSL type of a uniform, such as GL_FLOAT_VEC4.
+     */
+    GLenum type;
+    /**
+     * Location of a uniform, index of a block.
+     */
+    GLint location;
+    GLint arraySize;
+    /**
+     * Binding point and size in bytes of a block.
+     */
+    GLint binding, dataSize;
+    uint64_t _hash;
+    size_t _valueOffset;
+    bool _isValueKnown;
+} ProgramResource;
+
+/**
+ * Every active uniform and block of a linked program, enumerated once and found by name through a hash table.
+ * Resources are then used by index, and setters skip values the uniform already has. Uniforms inside blocks are
+ * left out, they are set through buffers. Storage blocks need OpenGL 4.3; setters set the program's uniforms
+ * directly with OpenGL 4.1 and need the program to be in use otherwise.
+ */
+typedef struct {
+    GLuint program;
+    ProgramResource *resources;
+    size_t count;
+    int32_t *_table;
+    size_t _tableMask;
+    unsigned char *_values;
+    /**
+     * Uniform uploads made and skipped because the uniform already had the value.
+     */
+    size_t uploads, skipped;
+} ProgramReflection;
+
+ProgramReflection *refl_build(GLuint program);
+
+/**
+ * Frees the reflection, the program is left alone.
+ */
+void refl_dispose(ProgramReflection *r);
+
+/**
+ * Index of the active resource of that kind and name, -1 if there is none. Setters ignore -1 as GL ignores location
+ * -1, so resources optimized out of the program need no special case.
+ */
+int32_t refl_find(const ProgramReflection *r, ReflectionKind kind, const char *name);
+
+/**
+ * Points a uniform or storage block at a binding point, unless it already uses it.
+ */
+void refl_setBlockBinding(ProgramReflection *r, int32_t block, GLuint binding);
+
+/**
+ * Also sets bools, samplers and images.
+ */
+void refl_setInt(ProgramReflection *r, int32_t uniform, GLint value);
+
+void refl_setFloat(ProgramReflection *r, int32_t uniform, GLfloat value);
+
+void refl_setVec3(ProgramReflection *r, int32_t uniform, const Vector3f *value);
+
+void refl_setVec4(ProgramReflection *r, int32_t uniform, const Vector4f *value);
+
+void refl_setMat4(ProgramReflection *r, int32_t uniform, const Matrix4f *value);
+
+#endif //REFLECTION_H
@@ -0,0 +1,190 @@
+#include "renderqueue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "glstate.h"
+
+#define DEPTH_BITS 24
+#define DEPTH_MASK ((1u << DEPTH_BITS) - 1)
+#define PROGRAM_MASK 0xFFFu
+#define MATERIAL_MASK 0xFFFu
+#define VERTEX_ARRAY_MASK 0x3FFFu
+
+RenderQueue *rq_allocate(const size_t capacity, const RenderMaterial materials[], const size_t materialCount,
+                         UniformRing *const ring) {
+    RenderQueue *q = calloc(1, sizeof(RenderQueue));
+    q->ring = ring;
+    q->materials = malloc(materialCount * sizeof(RenderMaterial));
+    memcpy(q->materials, materials, materialCount * sizeof(RenderMaterial));
+    q->materialCount = materialCount;
+    q->capacity = capacity;
+    q->items = malloc(capacity * sizeof(RenderItem));
+    q->entries = malloc(capacity * sizeof(RenderEntry));
+    q->_scratch = malloc(capacity * sizeof(RenderEntry));
+    return q;
+}
+
+void rq_dispose(RenderQueue *q) {
+    free(q->materials);
+    free(q->items);
+    free(q->entries);
+    free(q->_scratch);
+    for (size_t i = 0; i < q->_programCount; i++) refl_dispose(q->_programs[i].reflection);
+    free(q->_programs);
+    free(q);
+}
+
+void rq_forgetPrograms(RenderQueue *const q) {
+    for (size_t i = 0; i < q->_programCount; i++) refl_dispose(q->_programs[i].reflection);
+    q->_programCount = 0;
+}
+
+void rq_begin(RenderQueue *const q, const Camera *const camera) {
+    q->count = 0;
+    q->_vp = camera->vp;
+    q->_far = camera->far;
+}
+
+/**
+ * Distance along the view direction, the clip w of the model's origin, quantized over [0, far].
+ */
+static uint32_t quantizeDepth(const RenderQueue *const q, const Matrix4f *const model) {
+    const Matrix4f *const vp = q->_vp;
+    const float w = vp->t[0][3] * model->t[3][0] + vp->t[1][3] * model->t[3][1] + vp->t[2][3] * model->t[3][2] +
+                    vp->t[3][3];
+    const float depth = w / q->_far;
+    if (!(depth > 0.0f)) return 0;
+    if (depth >= 1.0f) return DEPTH_MASK;
+    return (uint32_t) (depth * (float) DEPTH_MASK);
+}
+
+void rq_submit(RenderQueue *const q, const Mesh *const mesh, const GLuint program, const uint32_t material,
+               const Matrix4f *const model) {
+    if (q->count == q->capacity) return;
+    const RenderLayer layer = q->materials[material].layer;
+    const uint64_t depth = quantizeDepth(q, model);
+    const uint64_t state = (uint64_t) (program & PROGRAM_MASK) << 26 | (uint64_t) (material & MATERIAL_MASK) << 14 |
+                           (mesh->vao & VERTEX_ARRAY_MASK);
+
+    uint64_t key = (uint64_t) layer << 62;
+    if (layer == RQ_LAYER_OPAQUE) {
+        // State first, then front to back so early depth tests reject hidden fragments
+        key |= state << DEPTH_BITS | depth;
+    } else {
+        // Back to front for blending, state only breaks ties
+        key |= (DEPTH_MASK - depth) << 38 | state;
+    }
+    q->items[q->count] = (RenderItem) {model, mesh, program, material};
+    q->entries[q->count] = (RenderEntry) {key, (uint32_t) q->count};
+    q->count++;
+}
+
+void rq_sort(RenderQueue *const q) {
+    if (q->count == 0) return;
+    size_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < q->count; i++) {
+        const uint64_t key = q->entries[i].key;
+        for (int digit = 0; digit < 8; digit++) histograms[digit][key >> 8 * digit & 0xFF]++;
+    }
+
+    RenderEntry *from = q->entries, *to = q->_scratch;
+    for (int digit = 0; digit < 8; digit++) {
+        size_t *const histogram = histograms[digit];
+        // A byte every key shares would only copy the entries
+        if (histogram[from[0].key >> 8 * digit & 0xFF] == q->count) continue;
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            const size_t count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < q->count; i++) {
+            to[histogram[from[i].key >> 8 * digit & 0xFF]++] = from[i];
+        }
+        RenderEntry *const temp = from;
+        from = to;
+        to = temp;
+    }
+    if (from != q->entries) {
+        q->_scratch = q->entries;
+        q->entries = from;
+    }
+}
+
+static const RenderProgram *getProgram(RenderQueue *const q, const GLuint program) {
+    for (size_t i = 0; i < q->_programCount; i++) {
+        if (q->_programs[i].program == program) return q->_programs + i;
+    }
+    if (q->_programCount == q->_programCapacity) {
+        q->_programCapacity = q->_programCapacity > 0 ? 2 * q->_programCapacity : 4;
+        q->_programs = realloc(q->_programs, q->_programCapacity * sizeof(RenderProgram));
+    }
+    RenderProgram *const res = q->_programs + q->_programCount++;
+    res->program = program;
+    res->reflection = refl_build(program);
+    res->tint = refl_find(res->reflection, REFL_UNIFORM, "tint");
+    refl_setBlockBinding(res->reflection, refl_find(res->reflection, REFL_UNIFORM_BLOCK, "Object"), RQ_OBJECT_BINDING);
+    return res;
+}
+
+static void setLayer(const RenderLayer layer) {
+    if (layer == RQ_LAYER_TRANSPARENT) {
+        gls_setBlend(true);
+        gls_blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        gls_depthMask(false);
+    } else {
+        gls_setBlend(false);
+        gls_depthMask(true);
+    }
+}
+
+void rq_execute(RenderQueue *const q) {
+    memset(&q->stats, 0, sizeof(RenderQueueStats));
+    if (q->count == 0) return;
+
+    const RenderProgram *program = NULL;
+    uint32_t material = UINT32_MAX;
+    GLuint vertexArray = 0;
+    RenderLayer layer = RQ_LAYER_OPAQUE;
+    setLayer(layer);
+    for (size_t i = 0; i < q->count; i++) {
+        const RenderItem *const item = q->items + q->entries[i].item;
+        const RenderMaterial *const m = q->materials + item->material;
+        const RingBlock object = ring_allocateBlock(q->ring, sizeof(item->model->t));
+        if (object.data == NULL) {
+            q->stats.dropped++;
+            continue;
+        }
+        memcpy(object.data, item->model->t, sizeof(item->model->t));
+
+        if (m->layer != layer) {
+            layer = m->layer;
+            setLayer(layer);
+            q->stats.layerChanges++;
+        }
+        if (program == NULL || program->program != item->program) {
+            program = getProgram(q, item->program);
+            gls_useProgram(program->program);
+            // Uniforms belong to the program, the new one needs the tint too, unless it kept it from earlier draws
+            material = UINT32_MAX;
+            q->stats.programChanges++;
+        }
+        if (item->material != material) {
+            material = item->material;
+            refl_setVec4(program->reflection, program->tint, &m->tint);
+            q->stats.materialChanges++;
+        }
+        if (item->mesh->vao != vertexArray) {
+            vertexArray = item->mesh->vao;
+            gls_bindVertexArray(vertexArray);
+            q->stats.vertexArrayChanges++;
+        }
+        ring_bind(q->ring, RQ_OBJECT_BINDING, &object);
+        mesh_drawBound(item->mesh);
+        q->stats.draws++;
+    }
+    if (layer != RQ_LAYER_OPAQUE) setLayer(RQ_LAYER_OPAQUE);
+}
@@ -0,0 +1,118 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "camera.h"
+#include "glad/glad.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+#include "mesh.h"
+#include "reflection.h"
+#include "uniformring.h"
+
+/**
+ * Uniform block binding of the std140 block Object {mat4 model;} each draw gets from the uniform ring.
+ */
+#define RQ_OBJECT_BINDING 2
+
+/**
+ * Layers are drawn in this order. Opaque draws are sorted by state and then front to back, transparent ones back to
+ * front with blending on and depth writes off.
+ */
+typedef enum {
+    RQ_LAYER_OPAQUE,
+    RQ_LAYER_TRANSPARENT,
+} RenderLayer;
+
+typedef struct {
+    Vector4f tint;
+    RenderLayer layer;
+} RenderMaterial;
+
+/**
+ * A submitted draw. The model matrix is not copied and must stay put until the queue is executed.
+ */
+typedef struct {
+    const Matrix4f *model;
+    const Mesh *mesh;
+    GLuint program;
+    uint32_t material;
+} RenderItem;
+
+typedef struct {
+    uint64_t key;
+    uint32_t item;
+} RenderEntry;
+
+/**
+ * State changes made by the last rq_execute, next to the number of draws and of the draws dropped because the
+ * uniform ring's region was full.
+ */
+typedef struct {
+    size_t draws, dropped;
+    size_t programChanges, materialChanges, vertexArrayChanges, layerChanges;
+} RenderQueueStats;
+
+typedef struct {
+    GLuint program;
+    ProgramReflection *reflection;
+    int32_t tint;
+} RenderProgram;
+
+/**
+ * Sorts a frame's draws by packed 64-bit keys and walks them in order, changing only the state that differs from
+ * the previous draw. From the most significant bits, an opaque key holds the layer, the program, the material, the
+ * vertex array and the depth; a transparent key holds the layer, the inverted depth and then the state. Programs
+ * read the uniform vec4 tint, the Camera block and the model matrix from the Object block, which the queue writes to
+ * a uniform ring instead of uploading it draw by draw.
+ */
+typedef struct {
+    RenderMaterial *materials;
+    size_t materialCount;
+    UniformRing *ring;
+    RenderItem *items;
+    RenderEntry *entries, *_scratch;
+    size_t count, capacity;
+    RenderProgram *_programs;
+    size_t _programCount, _programCapacity;
+    const Matrix4f *_vp;
+    float _far;
+    RenderQueueStats stats;
+} RenderQueue;
+
+/**
+ * Copies the material table, submissions refer to materials by their index in it. The ring needs room for
+ * ring_getBlockSpace(sizeof(Matrix4f)) bytes per draw in each region; the caller begins and ends its frames.
+ */
+RenderQueue *rq_allocate(size_t capacity, const RenderMaterial materials[], size_t materialCount, UniformRing *ring);
+
+void rq_dispose(RenderQueue *q);
+
+/**
+ * Drops what the queue learned about the programs it drew with. Call it when programs were rebuilt, since their
+ * names are reused for new programs.
+ */
+void rq_forgetPrograms(RenderQueue *q);
+
+/**
+ * Empties the queue for a frame seen by the camera, whose matrices must be up to date.
+ */
+void rq_begin(RenderQueue *q, const Camera *camera);
+
+/**
+ * Queues a draw of mesh with program and material, past the capacity draws are dropped.
+ */
+void rq_submit(RenderQueue *q, const Mesh *mesh, GLuint program, uint32_t material, const Matrix4f *model);
+
+/**
+ * Sorts the entries by key with a least significant digit radix sort, skipping the bytes all keys share.
+ */
+void rq_sort(RenderQueue *q);
+
+/**
+ * Draws the sorted entries and leaves blending off and depth writes on.
+ */
+void rq_execute(RenderQueue *q);
+
+#endif //RENDERQUEUE_H
@@ -0,0 +1,385 @@
+#include "shader.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include "programcache.h"
+#include "utility/log.h"
+
+// KHR_parallel_shader_compile and its ARB twin are not part of the loader, both use this value
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+typedef void (APIENTRYP MaxShaderCompilerThreadsFunction)(GLuint count);
+
+const char *resourceDirectory = "";
+const char *shaderDirectory = "shaders/";
+
+static bool isParallelCompileSupported = false;
+
+#define SHADER_INCLUDE_DEPTH 16
+
+__attribute__ ((format(printf, 2, 3)))
+static void llog(const char *const level, char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    glog(level, format, "shader", args);
+    va_end(args);
+}
+
+static bool isProgramLinked(const GLuint program) {
+    GLint isLinked;
+    glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+    if (isLinked == GL_FALSE) {
+        int logLength;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+
+        char *log = malloc(logLength * sizeof(char));
+        glGetProgramInfoLog(program, logLength, NULL, log);
+
+        llog(ERROR, "Shader program failed to link: %s", log);
+        free(log);
+        return false;
+    }
+    return true;
+}
+
+static bool isShaderCompiled(const GLuint shader) {
+    GLint isCompiled;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+    if (isCompiled == GL_FALSE) {
+        int logLength;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+
+        char *log = malloc(logLength * sizeof(char));
+        glGetShaderInfoLog(shader, logLength, NULL, log);
+
+        llog(ERROR, "Compilation failed: %s", log);
+        free(log);
+        return false;
+    }
+    return true;
+}
+
+GLenum shader_getType(const char *const filename) {
+    char temp[strlen(filename) + 1];
+    strcpy(temp, filename);
+    strtok(temp, ".");
+    const char *const token = strtok(NULL, ".");
+    if (token != NULL) {
+        if (strcmp(token, "vert") == 0) {
+            return GL_VERTEX_SHADER;
+        }
+        if (strcmp(token, "frag") == 0) {
+            return GL_FRAGMENT_SHADER;
+        }
+        if (strcmp(token, "geom") == 0) {
+            return GL_GEOMETRY_SHADER;
+        }
+        if (strcmp(token, "tesc") == 0) {
+            return GL_TESS_CONTROL_SHADER;
+        }
+        if (strcmp(token, "tese") == 0) {
+            return GL_TESS_EVALUATION_SHADER;
+        }
+        if (strcmp(token, "comp") == 0) {
+            return GL_COMPUTE_SHADER;
+        }
+    }
+    return GL_NONE;
+}
+
+static char *readFile(const char *const filename) {
+    const unsigned pathLength = strlen(resourceDirectory) + strlen(shaderDirectory) + strlen(filename) + 1;
+    char path[pathLength];
+    snprintf(path, pathLength, "%s%s%s", resourceDirectory, shaderDirectory, filename);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        llog(ERROR, "Failed to open a shader source. %s: %s", strerror(errno), path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const int size = (int) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *source = malloc((size + 1) * sizeof(char));
+
+    fread(source, sizeof(char), size, file);
+    source[size] = '\0';
+
+    fclose(file);
+    return source;
+}
+
+static void append(char **const text, size_t *const length, size_t *const capacity, const char *const part,
+                   const size_t partLength) {
+    if (*length + partLength + 1 > *capacity) {
+        while (*length + partLength + 1 > *capacity) *capacity *= 2;
+        *text = realloc(*text, *capacity);
+    }
+    memcpy(*text + *length, part, partLength);
+    *length += partLength;
+    (*text)[*length] = '\0';
+}
+
+/**
+ * Replaces each #include "file" line of source with that file from the shader directory, whose own includes are
+ * resolved the same way. Frees source. Returns NULL if a file cannot be read or includes nest deeper than
+ * SHADER_INCLUDE_DEPTH, which is how include cycles end.
+ */
+static char *resolveIncludes(char *source, const unsigned depth) {
+    if (strstr(source, "#include") == NULL) return source;
+
+    size_t length = 0, capacity = strlen(source) + 1;
+    char *res = malloc(capacity);
+    res[0] = '\0';
+    for (const char *line = source; *line != '\0';) {
+        const char *const newline = strchr(line, '\n');
+        const char *const next = newline != NULL ? newline + 1 : line + strlen(line);
+        const char *directive = line;
+        while (*directive == ' ' || *directive == '\t') directive++;
+        if (strncmp(directive, "#include", 8) != 0) {
+            append(&res, &length, &capacity, line, next - line);
+            line = next;
+            continue;
+        }
+
+        const char *const nameStart = memchr(directive, '"', next - directive);
+        const char *const nameEnd = nameStart != NULL ? memchr(nameStart + 1, '"', next - nameStart - 1) : NULL;
+        if (nameEnd == NULL) {
+            llog(ERROR, "Malformed include: %.*s", (int) (next - directive), directive);
+            free(source);
+            free(res);
+            return NULL;
+        }
+        char name[nameEnd - nameStart];
+        memcpy(name, nameStart + 1, nameEnd - nameStart - 1);
+        name[nameEnd - nameStart - 1] = '\0';
+        if (depth >= SHADER_INCLUDE_DEPTH) {
+            llog(ERROR, "Includes nest deeper than %d at %s, they probably include each other", SHADER_INCLUDE_DEPTH,
+                 name);
+            free(source);
+            free(res);
+            return NULL;
+        }
+
+        char *const included = readFile(name);
+        char *const resolved = included != NULL ? resolveIncludes(included, depth + 1) : NULL;
+        if (resolved == NULL) {
+            free(source);
+            free(res);
+            return NULL;
+        }
+        const size_t resolvedLength = strlen(resolved);
+        append(&res, &length, &capacity, resolved, resolvedLength);
+        if (resolvedLength > 0 && resolved[resolvedLength - 1] != '\n') append(&res, &length, &capacity, "\n", 1);
+        free(resolved);
+        line = next;
+    }
+    free(source);
+    return res;
+}
+
+char *shader_readSource(const char *const filename) {
+    char *const source = readFile(filename);
+    return source != NULL ? resolveIncludes(source, 0) : NULL;
+}
+
+char *shader_injectDefines(const char *const source, const char *const defines[], const size_t count) {
+    // Nothing but comments may come before the version directive
+    const char *body = source;
+    const char *const version = strstr(source, "#version");
+    if (version != NULL) {
+        const char *const newline = strchr(version, '\n');
+        body = newline != NULL ? newline + 1 : version + strlen(version);
+    }
+
+    size_t capacity = strlen(source) + 2;
+    for (size_t i = 0; i < count; i++) capacity += strlen("#define \n") + strlen(defines[i]);
+    size_t length = 0;
+    char *res = malloc(capacity);
+    res[0] = '\0';
+    append(&res, &length, &capacity, source, body - source);
+    if (length > 0 && res[length - 1] != '\n') append(&res, &length, &capacity, "\n", 1);
+    for (size_t i = 0; i < count; i++) {
+        append(&res, &length, &capacity, "#define ", 8);
+        append(&res, &length, &capacity, defines[i], strlen(defines[i]));
+        append(&res, &length, &capacity, "\n", 1);
+    }
+    append(&res, &length, &capacity, body, strlen(body));
+    return res;
+}
+
+/**
+ * Applies the state that is set after linking and is not part of program binaries.
+ */
+static GLuint finishProgram(const GLuint program) {
+    // Shaders before GLSL 4.20 cannot choose the binding themselves
+    const GLuint cameraBlock = glGetUniformBlockIndex(program, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX) glUniformBlockBinding(program, cameraBlock, SHADER_CAMERA_BINDING);
+    return program;
+}
+
+static void disposeJobShaders(ShaderJob *const job) {
+    for (size_t i = 0; i < job->_shaderCount; i++) {
+        glDetachShader(job->program, job->_shaders[i]);
+        glDeleteShader(job->_shaders[i]);
+    }
+    free(job->_shaders);
+    job->_shaders = NULL;
+    job->_shaderCount = 0;
+}
+
+/**
+ * Checks the compile and link status of a submitted job, which waits for the driver if it is still working on it.
+ */
+static void completeJob(ShaderJob *const job) {
+    bool isCompiled = true;
+    for (size_t i = 0; i < job->_shaderCount; i++) isCompiled = isShaderCompiled(job->_shaders[i]) && isCompiled;
+    // A link log after a failed compile only repeats that a shader did not compile
+    const bool isLinked = isCompiled && isProgramLinked(job->program);
+    disposeJobShaders(job);
+
+    if (!isLinked) {
+        llog(ERROR, "Failed to build the program of %s", job->_name);
+        glDeleteProgram(job->program);
+        job->program = 0;
+        job->state = SHADER_JOB_FAILED;
+        return;
+    }
+    if (job->_isCacheUsed) pcache_save(job->_cacheKey, job->program);
+    finishProgram(job->program);
+    job->state = SHADER_JOB_DONE;
+}
+
+bool shader_initParallelCompile() {
+    const char *function = NULL;
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile")) function = "glMaxShaderCompilerThreadsKHR";
+    else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile")) function = "glMaxShaderCompilerThreadsARB";
+    if (function == NULL) {
+        llog(INFO, "Parallel shader compiling is not supported, status checks are only deferred");
+        isParallelCompileSupported = false;
+        return false;
+    }
+
+    const MaxShaderCompilerThreadsFunction maxShaderCompilerThreads =
+            (MaxShaderCompilerThreadsFunction) glfwGetProcAddress(function);
+    // The largest count leaves the number of threads to the driver
+    if (maxShaderCompilerThreads != NULL) maxShaderCompilerThreads(0xFFFFFFFF);
+    llog(INFO, "Shaders are compiled in parallel by the driver");
+    isParallelCompileSupported = true;
+    return true;
+}
+
+ShaderJob *shader_submitProgram(const Shader shaders[], const size_t count) {
+    ShaderJob *job = malloc(sizeof(ShaderJob));
+    job->state = SHADER_JOB_PENDING;
+    job->_shaders = NULL;
+    job->_shaderCount = 0;
+    job->_isCacheUsed = pcache_isAvailable();
+    job->_cacheKey = job->_isCacheUsed ? pcache_getKey(shaders, count) : 0;
+
+    size_t nameLength = 1;
+    for (size_t i = 0; i < count; i++) nameLength += strlen(shaders[i].filename) + 2;
+    job->_name = malloc(nameLength * sizeof(char));
+    job->_name[0] = '\0';
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) strcat(job->_name, ", ");
+        strcat(job->_name, shaders[i].filename);
+    }
+
+    if (job->_isCacheUsed) {
+        job->program = pcache_load(job->_cacheKey);
+        if (job->program != 0) {
+            finishProgram(job->program);
+            job->state = SHADER_JOB_DONE;
+            return job;
+        }
+    }
+
+    // Everything is handed to the driver before any status is asked for, which would make it finish the work first
+    llog(INFO, "Submitting the program of %s", job->_name);
+    job->program = glCreateProgram();
+    job->_shaders = malloc(count * sizeof(GLuint));
+    job->_shaderCount = count;
+    for (size_t i = 0; i < count; i++) {
+        const GLuint shader = glCreateShader(shaders[i].type);
+        glShaderSource(shader, 1, &shaders[i].source, NULL);
+        glCompileShader(shader);
+        glAttachShader(job->program, shader);
+        job->_shaders[i] = shader;
+    }
+    if (job->_isCacheUsed) glProgramParameteri(job->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(job->program);
+    return job;
+}
+
+ShaderJob *shader_submitFiles(const char *const filenames[], const size_t count) {
+    // GCC cannot tell that only the entries read are used and warns about the rest otherwise
+    Shader shaders[count];
+    memset(shaders, 0, sizeof(shaders));
+    size_t readCount = 0;
+    for (; readCount < count; readCount++) {
+        const char *const filename = filenames[readCount];
+        const GLenum type = shader_getType(filename);
+        if (type == GL_NONE) {
+            llog(ERROR, "Unknown shader type for %s", filename);
+            break;
+        }
+        const char *const source = shader_readSource(filename);
+        if (source == NULL) break;
+        shaders[readCount] = (Shader) {filename, source, type};
+    }
+
+    if (readCount != count) {
+        for (size_t i = 0; i < readCount; i++) free((void *) shaders[i].source);
+        return NULL;
+    }
+
+    // The driver copies the sources when they are submitted
+    ShaderJob *job = shader_submitProgram(shaders, count);
+    for (size_t i = 0; i < count; i++) free((void *) shaders[i].source);
+    return job;
+}
+
+bool shader_pollJob(ShaderJob *const job) {
+    if (job->state != SHADER_JOB_PENDING) return true;
+    if (isParallelCompileSupported) {
+        GLint isCompleted;
+        glGetProgramiv(job->program, GL_COMPLETION_STATUS_KHR, &isCompleted);
+        if (isCompleted == GL_FALSE) return false;
+    }
+    completeJob(job);
+    return true;
+}
+
+GLuint shader_finishJob(ShaderJob *job) {
+    if (job->state == SHADER_JOB_PENDING) completeJob(job);
+    const GLuint program = job->program;
+    free(job->_name);
+    free(job);
+    return program;
+}
+
+void shader_cancelJob(ShaderJob *job) {
+    // Nothing queries the status, so the driver is never waited for
+    disposeJobShaders(job);
+    glDeleteProgram(job->program);
+    free(job->_name);
+    free(job);
+}
+
+GLuint shader_compileProgram(const Shader shaders[], const size_t count) {
+    return shader_finishJob(shader_submitProgram(shaders, count));
+}
+
+GLuint shader_loadProgram(const char *const filenames[], const size_t count) {
+    ShaderJob *job = shader_submitFiles(filenames, count);
+    return job != NULL ? shader_finishJob(job) : 0;
+}
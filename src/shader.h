@@ -0,0 +1,109 @@
+#ifndef SHADER_H
+#define SHADER_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glad/glad.h"
+
+/**
+ * Uniform block binding of the shared Camera block. Programs that declare the block get it bound here when they are
+ * linked.
+ */
+#define SHADER_CAMERA_BINDING 1
+
+typedef struct {
+    const char *filename;
+    const GLchar *source;
+    GLenum type;
+} Shader;
+
+typedef enum {
+    SHADER_JOB_PENDING,
+    SHADER_JOB_DONE,
+    SHADER_JOB_FAILED,
+} ShaderJobState;
+
+/**
+ * A program whose shaders are submitted for compiling and linking but whose status has not been checked yet, so the
+ * driver can work on it while the caller keeps going.
+ */
+typedef struct {
+    ShaderJobState state;
+    /**
+     * The program being linked, only usable once the state is SHADER_JOB_DONE.
+     */
+    GLuint program;
+    GLuint *_shaders;
+    size_t _shaderCount;
+    char *_name;
+    uint64_t _cacheKey;
+    bool _isCacheUsed;
+} ShaderJob;
+
+extern const char *resourceDirectory;
+extern const char *shaderDirectory;
+
+/**
+ * Shader stage from the extension of filename, GL_NONE if the extension is unknown. .comp files are compute shaders,
+ * which link into programs of their own.
+ */
+GLenum shader_getType(const char *filename);
+
+/**
+ * Reads a shader from the shader directory of the resource directory and replaces each #include "file" line with
+ * that file from the same directory. Returns NULL if a file cannot be read; the caller frees the source.
+ */
+char *shader_readSource(const char *filename);
+
+/**
+ * Copy of source with a #define line for each of defines right after the #version directive. A define is the name,
+ * optionally followed by a space and the value. The caller frees the copy.
+ */
+char *shader_injectDefines(const char *source, const char *const defines[], size_t count);
+
+/**
+ * Lets the driver compile and link on its own threads if it supports KHR_parallel_shader_compile, so that polling a
+ * job never waits. Needs a current context. Without the extension jobs still defer every status check until the
+ * caller asks for it, but that check waits for the driver.
+ */
+bool shader_initParallelCompile();
+
+/**
+ * Starts compiling the shaders and linking them into a program without waiting for either. A program found in the
+ * program cache gives a job that is already done.
+ */
+ShaderJob *shader_submitProgram(const Shader shaders[], size_t count);
+
+/**
+ * Reads the shader files and submits them as a program. Returns NULL and logs the reason if a file cannot be read.
+ */
+ShaderJob *shader_submitFiles(const char *const filenames[], size_t count);
+
+/**
+ * Checks the job without waiting when parallel compiling is supported. Returns true once the job is done or failed.
+ */
+bool shader_pollJob(ShaderJob *job);
+
+/**
+ * Waits for the job, frees it and returns its program. Returns 0 and logs the reason if compiling or linking failed.
+ */
+GLuint shader_finishJob(ShaderJob *job);
+
+/**
+ * Frees the job and deletes its program without waiting for the driver to finish with it.
+ */
+void shader_cancelJob(ShaderJob *job);
+
+/**
+ * Compiles the shaders and links them into a program. Returns 0 and logs the reason if that fails. Linked programs
+ * are kept in the program cache, and a program found there is loaded without compiling anything.
+ */
+GLuint shader_compileProgram(const Shader shaders[], size_t count);
+
+/**
+ * Reads, compiles and links the shader files into a program. Returns 0 and logs the reason if that fails.
+ */
+GLuint shader_loadProgram(const char *const filenames[], size_t count);
+
+#endif //SHADER_H
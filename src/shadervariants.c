@@ -0,0 +1,305 @@
+#include "shadervariants.h"
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "programcache.h"
+#include "utility/log.h"
+
+#define INITIAL_SLOT_CAPACITY 16
+
+/**
+ * A program shared by every variant, of any set, that expands to the same sources.
+ */
+typedef struct {
+    uint64_t key;
+    ShaderJob *job;
+    GLuint program;
+    size_t users;
+} SharedProgram;
+
+static SharedProgram *sharedPrograms = NULL;
+static size_t sharedCount = 0, sharedCapacity = 0;
+
+__attribute__ ((format(printf, 2, 3)))
+static void llog(const char *const level, char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    glog(level, format, "shadervariants", args);
+    va_end(args);
+}
+
+static char *copyString(const char *const string) {
+    char *copy = malloc(strlen(string) + 1);
+    strcpy(copy, string);
+    return copy;
+}
+
+static uint64_t getFeatureMask(const ShaderVariants *const v) {
+    return v->_featureCount == 64 ? UINT64_MAX : ((uint64_t) 1 << v->_featureCount) - 1;
+}
+
+static bool isIdentifierChar(const char c) {
+    return isalnum((unsigned char) c) || c == '_';
+}
+
+/**
+ * Whether the define's name, without its value, appears in source as a whole identifier. Stages that never
+ * mention a feature are left alone, so turning it on does not change their sources or keys.
+ */
+static bool isMentioned(const char *const source, const char *const define) {
+    const char *const space = strchr(define, ' ');
+    const size_t nameLength = space != NULL ? (size_t) (space - define) : strlen(define);
+    char name[nameLength + 1];
+    memcpy(name, define, nameLength);
+    name[nameLength] = '\0';
+    // FLAT must not be found in FLATTEN or NOT_FLAT
+    for (const char *found = strstr(source, name); found != NULL; found = strstr(found + 1, name)) {
+        const bool isStart = found == source || !isIdentifierChar(found[-1]);
+        if (isStart && !isIdentifierChar(found[nameLength])) return true;
+    }
+    return false;
+}
+
+/**
+ * Index of the shared program with the key, submitting the stages as a new one if there is none.
+ */
+static size_t acquireProgram(const uint64_t key, const Shader stages[], const size_t count) {
+    // Programs number in the dozens, a scan costs nothing next to the compile it saves
+    size_t freeIndex = sharedCount;
+    for (size_t i = 0; i < sharedCount; i++) {
+        if (sharedPrograms[i].users == 0) {
+            if (freeIndex == sharedCount) freeIndex = i;
+            continue;
+        }
+        if (sharedPrograms[i].key == key) {
+            llog(INFO, "Variant of %s expands like an earlier one and shares its program", stages[0].filename);
+            sharedPrograms[i].users++;
+            return i;
+        }
+    }
+
+    if (freeIndex == sharedCount) {
+        if (sharedCount == sharedCapacity) {
+            sharedCapacity = sharedCapacity == 0 ? INITIAL_SLOT_CAPACITY : sharedCapacity * 2;
+            sharedPrograms = realloc(sharedPrograms, sharedCapacity * sizeof(SharedProgram));
+        }
+        sharedCount++;
+    }
+    sharedPrograms[freeIndex] = (SharedProgram) {key, shader_submitProgram(stages, count), 0, 1};
+    return freeIndex;
+}
+
+static void releaseProgram(const size_t index) {
+    SharedProgram *const shared = sharedPrograms + index;
+    if (--shared->users > 0) return;
+    // A rebuild superseded by a newer save is dropped while still compiling, without a hitch
+    if (shared->job != NULL) shader_cancelJob(shared->job);
+    else glDeleteProgram(shared->program);
+    shared->job = NULL;
+    shared->program = 0;
+}
+
+static size_t buildVariant(const ShaderVariants *const v, const uint64_t features) {
+    Shader stages[v->_stageCount];
+    const char *defines[v->_featureCount > 0 ? v->_featureCount : 1];
+    for (size_t s = 0; s < v->_stageCount; s++) {
+        const Shader *const stage = v->_stages + s;
+        size_t defineCount = 0;
+        for (size_t f = 0; f < v->_featureCount; f++) {
+            if (features & (uint64_t) 1 << f && isMentioned(stage->source, v->_features[f])) {
+                defines[defineCount++] = v->_features[f];
+            }
+        }
+        stages[s] = (Shader) {stage->filename, shader_injectDefines(stage->source, defines, defineCount), stage->type};
+    }
+
+    llog(INFO, "Building variant %#" PRIx64 " of %s", features, v->_stages[0].filename);
+    const size_t program = acquireProgram(pcache_getKey(stages, v->_stageCount), stages, v->_stageCount);
+    // The driver has its own copies of the sources once they are submitted
+    for (size_t s = 0; s < v->_stageCount; s++) free((void *) stages[s].source);
+    return program;
+}
+
+static VariantSlot *findSlot(const ShaderVariants *const v, const uint64_t features) {
+    // Finalizer of splitmix64, spreads masks that differ in a few low bits over the whole table
+    uint64_t hash = features;
+    hash = (hash ^ hash >> 30) * 0xBF58476D1CE4E5B9;
+    hash = (hash ^ hash >> 27) * 0x94D049BB133111EB;
+    hash ^= hash >> 31;
+
+    const size_t mask = v->_slotCapacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        VariantSlot *const slot = v->_slots + i;
+        if (!slot->isUsed || slot->features == features) return slot;
+    }
+}
+
+static void growSlots(ShaderVariants *const v) {
+    VariantSlot *const oldSlots = v->_slots;
+    const size_t oldCapacity = v->_slotCapacity;
+    v->_slotCapacity *= 2;
+    v->_slots = calloc(v->_slotCapacity, sizeof(VariantSlot));
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].isUsed) *findSlot(v, oldSlots[i].features) = oldSlots[i];
+    }
+    free(oldSlots);
+}
+
+/**
+ * Slot of the variant, building the variant first if it has not been asked for yet.
+ */
+static VariantSlot *getVariant(ShaderVariants *const v, uint64_t features) {
+    features &= getFeatureMask(v);
+    VariantSlot *slot = findSlot(v, features);
+    if (slot->isUsed) return slot;
+
+    // Keeps at least half of the table free so probes stay short
+    if (2 * (v->_variantCount + 1) > v->_slotCapacity) {
+        growSlots(v);
+        slot = findSlot(v, features);
+    }
+    *slot = (VariantSlot) {features, buildVariant(v, features), 0, true, false};
+    v->_variantCount++;
+    return slot;
+}
+
+ShaderVariants *svar_allocate(const char *const filenames[], const size_t count, const char *const features[],
+                              const size_t featureCount) {
+    if (count == 0) {
+        llog(ERROR, "Variants need at least one shader file");
+        return NULL;
+    }
+    if (featureCount > SVAR_MAX_FEATURES) {
+        llog(ERROR, "%zu features given, variants can have at most %d", featureCount, SVAR_MAX_FEATURES);
+        return NULL;
+    }
+
+    Shader *stages = malloc(count * sizeof(Shader));
+    for (size_t i = 0; i < count; i++) {
+        const GLenum type = shader_getType(filenames[i]);
+        char *const source = type != GL_NONE ? shader_readSource(filenames[i]) : NULL;
+        if (source == NULL) {
+            if (type == GL_NONE) llog(ERROR, "Unknown shader type for %s", filenames[i]);
+            for (size_t j = 0; j < i; j++) {
+                free((void *) stages[j].filename);
+                free((void *) stages[j].source);
+            }
+            free(stages);
+            return NULL;
+        }
+        stages[i] = (Shader) {copyString(filenames[i]), source, type};
+    }
+
+    ShaderVariants *v = malloc(sizeof(ShaderVariants));
+    v->_stages = stages;
+    v->_stageCount = count;
+    v->_features = malloc(featureCount * sizeof(char *));
+    for (size_t i = 0; i < featureCount; i++) v->_features[i] = copyString(features[i]);
+    v->_featureCount = featureCount;
+    v->_slotCapacity = INITIAL_SLOT_CAPACITY;
+    v->_slots = calloc(v->_slotCapacity, sizeof(VariantSlot));
+    v->_variantCount = 0;
+    v->reloads = 0;
+    return v;
+}
+
+void svar_dispose(ShaderVariants *v) {
+    for (size_t i = 0; i < v->_slotCapacity; i++) {
+        if (!v->_slots[i].isUsed) continue;
+        releaseProgram(v->_slots[i].program);
+        if (v->_slots[i].isReplacing) releaseProgram(v->_slots[i].replacement);
+    }
+    for (size_t i = 0; i < v->_stageCount; i++) {
+        free((void *) v->_stages[i].filename);
+        free((void *) v->_stages[i].source);
+    }
+    for (size_t i = 0; i < v->_featureCount; i++) free(v->_features[i]);
+    free(v->_stages);
+    free(v->_features);
+    free(v->_slots);
+    free(v);
+}
+
+void svar_prepare(ShaderVariants *const v, const uint64_t features) {
+    getVariant(v, features);
+}
+
+bool svar_reload(ShaderVariants *const v) {
+    char *sources[v->_stageCount];
+    for (size_t i = 0; i < v->_stageCount; i++) {
+        sources[i] = shader_readSource(v->_stages[i].filename);
+        if (sources[i] == NULL) {
+            llog(ERROR, "Keeping the previous variants of %s", v->_stages[0].filename);
+            for (size_t j = 0; j < i; j++) free(sources[j]);
+            return false;
+        }
+    }
+    for (size_t i = 0; i < v->_stageCount; i++) {
+        free((void *) v->_stages[i].source);
+        v->_stages[i].source = sources[i];
+    }
+
+    for (size_t i = 0; i < v->_slotCapacity; i++) {
+        VariantSlot *const slot = v->_slots + i;
+        if (!slot->isUsed) continue;
+        // A rebuild of older sources still running is superseded
+        if (slot->isReplacing) releaseProgram(slot->replacement);
+        slot->replacement = buildVariant(v, slot->features);
+        slot->isReplacing = true;
+    }
+    return true;
+}
+
+/**
+ * Whether the shared program is done compiling, finishing its job if it just got done.
+ */
+static bool pollProgram(const size_t index) {
+    SharedProgram *const shared = sharedPrograms + index;
+    if (shared->job == NULL) return true;
+    if (!shader_pollJob(shared->job)) return false;
+    shared->program = shader_finishJob(shared->job);
+    shared->job = NULL;
+    return true;
+}
+
+bool svar_poll(ShaderVariants *const v) {
+    bool isFinished = true;
+    for (size_t i = 0; i < v->_slotCapacity; i++) {
+        VariantSlot *const slot = v->_slots + i;
+        if (!slot->isUsed) continue;
+        if (!pollProgram(slot->program)) isFinished = false;
+        if (!slot->isReplacing) continue;
+        if (!pollProgram(slot->replacement)) {
+            isFinished = false;
+            continue;
+        }
+
+        slot->isReplacing = false;
+        if (sharedPrograms[slot->replacement].program == 0) {
+            llog(ERROR, "Keeping the previous program of variant %#" PRIx64 " of %s", slot->features,
+                 v->_stages[0].filename);
+            releaseProgram(slot->replacement);
+            continue;
+        }
+        // Sources of this variant that did not change expand to the same key and the same program
+        if (slot->replacement != slot->program) v->reloads++;
+        releaseProgram(slot->program);
+        slot->program = slot->replacement;
+    }
+    return isFinished;
+}
+
+GLuint svar_get(ShaderVariants *const v, const uint64_t features) {
+    // Building the variant can move the shared programs, so they are indexed only after it
+    const size_t index = getVariant(v, features)->program;
+    SharedProgram *const shared = sharedPrograms + index;
+    if (shared->job != NULL) {
+        shared->program = shader_finishJob(shared->job);
+        shared->job = NULL;
+    }
+    return shared->program;
+}
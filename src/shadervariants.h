@@ -0,0 +1,77 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "glad/glad.h"
+#include "shader.h"
+
+/**
+ * Most features a set of variants can have, one bit each of the feature mask.
+ */
+#define SVAR_MAX_FEATURES 64
+
+typedef struct {
+    uint64_t features;
+    size_t program, replacement;
+    bool isUsed, isReplacing;
+} VariantSlot;
+
+/**
+ * Programs built from the same shader files with different sets of features turned on, each feature being a
+ * #define injected into the stages that mention its name. A variant is compiled the first time it is asked for,
+ * and variants whose expanded sources come out the same, here or in another set, share one program.
+ */
+typedef struct {
+    Shader *_stages;
+    size_t _stageCount;
+    char **_features;
+    size_t _featureCount;
+    VariantSlot *_slots;
+    size_t _slotCapacity, _variantCount;
+    /**
+     * Variants swapped for rebuilt ones so far. Programs got from svar_get before it changed are deleted.
+     */
+    size_t reloads;
+} ShaderVariants;
+
+/**
+ * Reads the shader files, resolving their includes once for all variants. A feature is a define name, optionally
+ * followed by a space and its value. Returns NULL and logs the reason if no files or more than SVAR_MAX_FEATURES
+ * features are given, or if a file cannot be read.
+ */
+ShaderVariants *svar_allocate(const char *const filenames[], size_t count, const char *const features[],
+                              size_t featureCount);
+
+/**
+ * Deletes the programs no other set of variants shares.
+ */
+void svar_dispose(ShaderVariants *v);
+
+/**
+ * Submits the variant with the features of the mask turned on for compiling without waiting for it, so it is ready
+ * or close to it by the time it is first used.
+ */
+void svar_prepare(ShaderVariants *v, uint64_t features);
+
+/**
+ * Reads the shader files again and submits a rebuild of every variant asked for so far. Each variant keeps its
+ * program until svar_poll finds the rebuild done, and keeps it for good if the rebuild fails. Returns false and
+ * keeps the previous sources if a file cannot be read.
+ */
+bool svar_reload(ShaderVariants *v);
+
+/**
+ * Checks the variants and rebuilds that are still compiling without waiting, swapping in the rebuilt programs.
+ * Returns true once none are left.
+ */
+bool svar_poll(ShaderVariants *v);
+
+/**
+ * Program of the variant with the features of the mask turned on, compiling it or waiting for it if needed. Returns
+ * 0 if it failed to build, which is only tried once.
+ */
+GLuint svar_get(ShaderVariants *v, uint64_t features);
+
+#endif //SHADERVARIANTS_H
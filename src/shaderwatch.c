@@ -0,0 +1,226 @@
+#include "shaderwatch.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "utility/log.h"
+
+#define INITIAL_CAPACITY 4
+
+__attribute__ ((format(printf, 2, 3)))
+static void llog(const char *const level, char *const format, ...) {
+    va_list args;
+    va_start(args, format);
+    glog(level, format, "shaderwatch", args);
+    va_end(args);
+}
+
+/**
+ * Whether the file is a shader stage or an include, going by its last extension so that editors' swap and backup
+ * files are left out.
+ */
+static bool isShaderFile(const char *const name) {
+    static const char *const extensions[] = {".vert", ".frag", ".geom", ".tesc", ".tese", ".comp", ".glsl"};
+    const char *const extension = strrchr(name, '.');
+    if (name[0] == '.' || extension == NULL) return false;
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++) {
+        if (strcmp(extension, extensions[i]) == 0) return true;
+    }
+    return false;
+}
+
+static void markAllStale(const ShaderWatcher *const w) {
+    for (size_t i = 0; i < w->count; i++) w->programs[i]->_isStale = true;
+}
+
+static void markChanged(const ShaderWatcher *const w, const char *const name) {
+    const size_t length = strlen(name);
+    if (length > 5 && strcmp(name + length - 5, ".glsl") == 0) {
+        markAllStale(w);
+        return;
+    }
+    for (size_t i = 0; i < w->count; i++) {
+        WatchedProgram *const p = w->programs[i];
+        for (size_t f = 0; f < p->_count; f++) {
+            if (strcmp(p->_filenames[f], name) == 0) p->_isStale = true;
+        }
+    }
+}
+
+static void readEvents(const ShaderWatcher *const w) {
+#ifdef __linux__
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    // The descriptor never blocks, the loop ends when no events are left
+    while ((length = read(w->_fd, buffer, sizeof(buffer))) > 0) {
+        const struct inotify_event *event;
+        for (const char *p = buffer; p < buffer + length; p += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event *) p;
+            // Events were lost, any file may have changed
+            if (event->mask & IN_Q_OVERFLOW) markAllStale(w);
+            else if (event->len > 0 && isShaderFile(event->name)) markChanged(w, event->name);
+        }
+    }
+#else
+    (void) w;
+#endif
+}
+
+ShaderWatcher *swatch_allocate() {
+    ShaderWatcher *w = malloc(sizeof(ShaderWatcher));
+    w->_fd = -1;
+    w->programs = NULL;
+    w->count = 0;
+    w->capacity = 0;
+    w->reloads = 0;
+    w->failures = 0;
+
+#ifdef __linux__
+    const size_t pathLength = strlen(resourceDirectory) + strlen(shaderDirectory) + 1;
+    char path[pathLength];
+    snprintf(path, pathLength, "%s%s", resourceDirectory, shaderDirectory);
+    w->_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Editors that save through a temporary file rename it over the old one instead of writing to it
+    if (w->_fd >= 0 && inotify_add_watch(w->_fd, path, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(w->_fd);
+        w->_fd = -1;
+    }
+    if (w->_fd < 0) {
+        llog(ERROR, "Cannot watch %s for shader changes. %s", path, strerror(errno));
+    } else {
+        llog(INFO, "Watching %s for shader changes", path);
+    }
+#else
+    llog(INFO, "Shaders are not reloaded, watching files needs inotify");
+#endif
+    return w;
+}
+
+static void disposeWatched(WatchedProgram *const p) {
+    if (p->_job != NULL) shader_cancelJob(p->_job);
+    if (p->_compute == NULL && p->_variants == NULL) glDeleteProgram(p->program);
+    for (size_t f = 0; f < p->_count; f++) free(p->_filenames[f]);
+    free(p->_filenames);
+    free(p);
+}
+
+void swatch_dispose(ShaderWatcher *w) {
+    for (size_t i = 0; i < w->count; i++) disposeWatched(w->programs[i]);
+    if (w->_fd >= 0) close(w->_fd);
+    free(w->programs);
+    free(w);
+}
+
+static WatchedProgram *addWatched(ShaderWatcher *const w, const char *const filenames[], const size_t count) {
+    if (w->count == w->capacity) {
+        w->capacity = w->capacity == 0 ? INITIAL_CAPACITY : w->capacity * 2;
+        w->programs = realloc(w->programs, w->capacity * sizeof(WatchedProgram *));
+    }
+    WatchedProgram *p = malloc(sizeof(WatchedProgram));
+    p->program = 0;
+    p->_compute = NULL;
+    p->_variants = NULL;
+    p->_filenames = malloc(count * sizeof(char *));
+    for (size_t i = 0; i < count; i++) {
+        p->_filenames[i] = malloc(strlen(filenames[i]) + 1);
+        strcpy(p->_filenames[i], filenames[i]);
+    }
+    p->_count = count;
+    p->_job = NULL;
+    p->_isStale = false;
+    w->programs[w->count++] = p;
+    return p;
+}
+
+const WatchedProgram *swatch_add(ShaderWatcher *const w, const GLuint program, const char *const filenames[],
+                                 const size_t count) {
+    WatchedProgram *const p = addWatched(w, filenames, count);
+    p->program = program;
+    return p;
+}
+
+const WatchedProgram *swatch_addCompute(ShaderWatcher *const w, ComputeProgram *const p, const char *const filename) {
+    WatchedProgram *const watched = addWatched(w, &filename, 1);
+    watched->_compute = p;
+    return watched;
+}
+
+const WatchedProgram *swatch_addVariants(ShaderWatcher *const w, ShaderVariants *const v) {
+    const char *filenames[v->_stageCount];
+    for (size_t i = 0; i < v->_stageCount; i++) filenames[i] = v->_stages[i].filename;
+    WatchedProgram *const p = addWatched(w, filenames, v->_stageCount);
+    p->_variants = v;
+    return p;
+}
+
+void swatch_remove(ShaderWatcher *const w, const WatchedProgram *const p) {
+    for (size_t i = 0; i < w->count; i++) {
+        if (w->programs[i] != p) continue;
+        disposeWatched(w->programs[i]);
+        memmove(w->programs + i, w->programs + i + 1, (w->count - i - 1) * sizeof(WatchedProgram *));
+        w->count--;
+        return;
+    }
+}
+
+/**
+ * Reloads the variants if their files changed and swaps in the rebuilds that are done. The variants keep their
+ * programs when a rebuild fails and log it themselves.
+ */
+static void updateVariants(ShaderWatcher *const w, WatchedProgram *const p) {
+    const size_t reloads = p->_variants->reloads;
+    svar_poll(p->_variants);
+    w->reloads += p->_variants->reloads - reloads;
+
+    if (!p->_isStale) return;
+    p->_isStale = false;
+    if (!svar_reload(p->_variants)) w->failures++;
+}
+
+void swatch_update(ShaderWatcher *const w) {
+    if (w->_fd < 0) return;
+    readEvents(w);
+
+    for (size_t i = 0; i < w->count; i++) {
+        WatchedProgram *const p = w->programs[i];
+        if (p->_variants != NULL) {
+            updateVariants(w, p);
+            continue;
+        }
+        if (p->_job != NULL) {
+            if (!shader_pollJob(p->_job)) continue;
+            const GLuint program = shader_finishJob(p->_job);
+            p->_job = NULL;
+            if (program == 0) {
+                llog(ERROR, "Keeping the previous program of %s", p->_filenames[0]);
+                w->failures++;
+            } else {
+                // The old program stays alive until the draws and dispatches already submitted with it are done
+                if (p->_compute != NULL) {
+                    comp_replaceProgram(p->_compute, program);
+                } else {
+                    glDeleteProgram(p->program);
+                    p->program = program;
+                }
+                llog(INFO, "Reloaded the program of %s", p->_filenames[0]);
+                w->reloads++;
+            }
+        }
+
+        // Files saved again while a rebuild was running get another one after it
+        if (!p->_isStale || p->_job != NULL) continue;
+        p->_isStale = false;
+        p->_job = shader_submitFiles((const char *const *) p->_filenames, p->_count);
+        if (p->_job == NULL) {
+            llog(ERROR, "Keeping the previous program of %s", p->_filenames[0]);
+            w->failures++;
+        }
+    }
+}
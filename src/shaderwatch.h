@@ -0,0 +1,78 @@
+#ifndef SHADERWATCH_H
+#define SHADERWATCH_H
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "compute.h"
+#include "glad/glad.h"
+#include "shader.h"
+#include "shadervariants.h"
+
+/**
+ * A program rebuilt from its files whenever one of them changes. Renderers read program every frame, it only ever
+ * changes inside swatch_update. Compute programs are rebuilt in place and sets of variants rebuild themselves, their
+ * program is left at 0.
+ */
+typedef struct {
+    GLuint program;
+    ComputeProgram *_compute;
+    ShaderVariants *_variants;
+    char **_filenames;
+    size_t _count;
+    ShaderJob *_job;
+    bool _isStale;
+} WatchedProgram;
+
+/**
+ * Watches the shader directory of the resource directory with inotify and rebuilds the programs whose files change.
+ * Rebuilds are compile jobs polled once per frame, so the render loop never waits for them, and a program that
+ * fails to build leaves the previous one in place. A changed .glsl file is taken to be included by every program.
+ * Without inotify nothing is ever rebuilt.
+ */
+typedef struct {
+    int _fd;
+    WatchedProgram **programs;
+    size_t count, capacity;
+    /**
+     * Programs swapped for rebuilt ones and rebuilds that failed so far.
+     */
+    size_t reloads, failures;
+} ShaderWatcher;
+
+ShaderWatcher *swatch_allocate();
+
+/**
+ * Deletes every watched program added with swatch_add along with the watcher.
+ */
+void swatch_dispose(ShaderWatcher *w);
+
+/**
+ * Starts watching the files program was built from. The watcher takes the program over and deletes it when it is
+ * replaced or the watcher is disposed.
+ */
+const WatchedProgram *swatch_add(ShaderWatcher *w, GLuint program, const char *const filenames[], size_t count);
+
+/**
+ * Starts watching the file the compute program was loaded from, swapping rebuilds into it. The program stays the
+ * caller's, who must remove it from the watcher before disposing it.
+ */
+const WatchedProgram *swatch_addCompute(ShaderWatcher *w, ComputeProgram *p, const char *filename);
+
+/**
+ * Starts watching the files of the variants, reloading them all when one changes and polling them on every update.
+ * The variants stay the caller's, who must remove them from the watcher before disposing them.
+ */
+const WatchedProgram *swatch_addVariants(ShaderWatcher *w, ShaderVariants *v);
+
+/**
+ * Stops watching, deleting the program if it was added with swatch_add.
+ */
+void swatch_remove(ShaderWatcher *w, const WatchedProgram *p);
+
+/**
+ * Picks up file changes, submits rebuilds and swaps in the programs that finished building, without waiting for
+ * anything. Call it between frames so a frame never mixes an old program with a new one.
+ */
+void swatch_update(ShaderWatcher *w);
+
+#endif //SHADERWATCH_H
@@ -0,0 +1,178 @@
+#include "transform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void *reallocateArray(void *const array, const size_t count, const size_t capacity, const size_t size,
+                             const size_t alignment) {
+    void *const res = aligned_alloc(alignment, capacity * size);
+    if (array != NULL) memcpy(res, array, count * size);
+    free(array);
+    return res;
+}
+
+static void reserve(TransformTree *const t, const size_t capacity) {
+#define RESERVE(array) \
+    t->array = reallocateArray(t->array, t->count, capacity, sizeof(*t->array), _Alignof(__typeof__(*t->array)))
+    RESERVE(positions);
+    RESERVE(orientations);
+    RESERVE(scales);
+    RESERVE(locals);
+    RESERVE(worlds);
+    RESERVE(_parentSlots);
+    RESERVE(_depths);
+    RESERVE(_ids);
+    RESERVE(_slots);
+    RESERVE(_isLocalUpdateNeeded);
+    RESERVE(_isWorldChanged);
+#undef RESERVE
+    t->capacity = capacity;
+}
+
+/**
+ * Opens an empty slot so that nodes from slot on move one place further.
+ */
+static void insertSlot(TransformTree *const t, const uint32_t slot) {
+    const size_t moved = t->count - slot;
+#define SHIFT(array) memmove(t->array + slot + 1, t->array + slot, moved * sizeof(*t->array))
+    SHIFT(positions);
+    SHIFT(orientations);
+    SHIFT(scales);
+    SHIFT(locals);
+    SHIFT(worlds);
+    SHIFT(_parentSlots);
+    SHIFT(_depths);
+    SHIFT(_ids);
+    SHIFT(_isLocalUpdateNeeded);
+    SHIFT(_isWorldChanged);
+#undef SHIFT
+    for (size_t i = slot + 1; i <= t->count; i++) {
+        if (t->_parentSlots[i] != TR_NO_PARENT && t->_parentSlots[i] >= slot) t->_parentSlots[i]++;
+        t->_slots[t->_ids[i]] = (uint32_t) i;
+    }
+}
+
+TransformTree *tr_allocate(const size_t capacity) {
+    TransformTree *t = calloc(1, sizeof(TransformTree));
+    reserve(t, capacity > 0 ? capacity : 1);
+    return t;
+}
+
+void tr_dispose(TransformTree *t) {
+    free(t->positions);
+    free(t->orientations);
+    free(t->scales);
+    free(t->locals);
+    free(t->worlds);
+    free(t->_parentSlots);
+    free(t->_depths);
+    free(t->_ids);
+    free(t->_slots);
+    free(t->_isLocalUpdateNeeded);
+    free(t->_isWorldChanged);
+    free(t);
+}
+
+TransformId tr_add(TransformTree *const t, const TransformId parent) {
+    if (t->count == t->capacity) reserve(t, 2 * t->capacity);
+
+    // The node goes after the last node of its depth, which keeps the arrays sorted by depth
+    const uint32_t parentSlot = parent == TR_NO_PARENT ? TR_NO_PARENT : t->_slots[parent];
+    const uint32_t depth = parent == TR_NO_PARENT ? 0 : t->_depths[parentSlot] + 1;
+    uint32_t slot = parent == TR_NO_PARENT ? 0 : parentSlot + 1;
+    while (slot < t->count && t->_depths[slot] <= depth) slot++;
+    insertSlot(t, slot);
+
+    const TransformId id = (TransformId) t->count;
+    t->count++;
+    t->positions[slot] = (Vector3f) {0.0f, 0.0f, 0.0f};
+    quat_identity(t->orientations + slot);
+    t->scales[slot] = (Vector3f) {1.0f, 1.0f, 1.0f};
+    mat_identity(t->locals + slot);
+    mat_identity(t->worlds + slot);
+    t->_parentSlots[slot] = parentSlot;
+    t->_depths[slot] = depth;
+    t->_ids[slot] = id;
+    t->_slots[id] = slot;
+    t->_isLocalUpdateNeeded[slot] = true;
+    t->_isWorldChanged[slot] = false;
+    t->_isUpdateNeeded = true;
+    return id;
+}
+
+void tr_setPosition(TransformTree *const t, const TransformId id, const Vector3f *const position) {
+    const uint32_t slot = t->_slots[id];
+    t->positions[slot] = *position;
+    t->_isLocalUpdateNeeded[slot] = true;
+    t->_isUpdateNeeded = true;
+}
+
+void tr_setOrientation(TransformTree *const t, const TransformId id, const Quatf *const orientation) {
+    const uint32_t slot = t->_slots[id];
+    t->orientations[slot] = *orientation;
+    t->_isLocalUpdateNeeded[slot] = true;
+    t->_isUpdateNeeded = true;
+}
+
+void tr_setScale(TransformTree *const t, const TransformId id, const Vector3f *const scale) {
+    const uint32_t slot = t->_slots[id];
+    t->scales[slot] = *scale;
+    t->_isLocalUpdateNeeded[slot] = true;
+    t->_isUpdateNeeded = true;
+}
+
+static void updateLocal(TransformTree *const t, const uint32_t slot) {
+    Matrix4f *const local = t->locals + slot;
+    const Vector3f *const scale = t->scales + slot;
+    const Vector3f *const position = t->positions + slot;
+    mat_rotationQuat(local, t->orientations + slot);
+    for (int row = 0; row < 3; row++) {
+        local->t[0][row] *= scale->x;
+        local->t[1][row] *= scale->y;
+        local->t[2][row] *= scale->z;
+    }
+    local->t[3][0] = position->x;
+    local->t[3][1] = position->y;
+    local->t[3][2] = position->z;
+}
+
+size_t tr_update(TransformTree *const t) {
+    if (!t->_isUpdateNeeded) {
+        if (t->_hasChangedWorlds) memset(t->_isWorldChanged, 0, t->count * sizeof(bool));
+        t->_hasChangedWorlds = false;
+        return 0;
+    }
+
+    size_t updated = 0;
+    for (uint32_t slot = 0; slot < t->count; slot++) {
+        const uint32_t parentSlot = t->_parentSlots[slot];
+        const bool isLocalChanged = t->_isLocalUpdateNeeded[slot];
+        if (isLocalChanged) {
+            updateLocal(t, slot);
+            t->_isLocalUpdateNeeded[slot] = false;
+        }
+
+        // Parents come first, so their flags already say whether their world matrices changed in this pass
+        const bool isWorldChanged = isLocalChanged || (parentSlot != TR_NO_PARENT && t->_isWorldChanged[parentSlot]);
+        if (isWorldChanged) {
+            if (parentSlot == TR_NO_PARENT) {
+                t->worlds[slot] = t->locals[slot];
+            } else {
+                mat_multMat4f(t->worlds + parentSlot, t->locals + slot, t->worlds + slot);
+            }
+            updated++;
+        }
+        t->_isWorldChanged[slot] = isWorldChanged;
+    }
+    t->_isUpdateNeeded = false;
+    t->_hasChangedWorlds = updated > 0;
+    return updated;
+}
+
+const Matrix4f *tr_getWorld(const TransformTree *const t, const TransformId id) {
+    return t->worlds + t->_slots[id];
+}
+
+bool tr_isWorldChanged(const TransformTree *const t, const TransformId id) {
+    return t->_isWorldChanged[t->_slots[id]];
+}
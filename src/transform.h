@@ -0,0 +1,66 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "math/matrix.h"
+#include "math/quaternion.h"
+#include "math/vector.h"
+
+typedef uint32_t TransformId;
+
+#define TR_NO_PARENT UINT32_MAX
+
+/**
+ * Scene node transforms. Nodes live in contiguous arrays sorted by depth, so every parent is stored before its
+ * children and tr_update can compose world matrices in a single pass. The local matrix of a node is
+ * translation * rotation * scale and its world matrix is the parent's world matrix times the local one.
+ * Ids stay valid while nodes are added, their slots in the arrays do not.
+ */
+typedef struct {
+    size_t count, capacity;
+    Vector3f *positions;
+    Quatf *orientations;
+    Vector3f *scales;
+    Matrix4f *locals;
+    Matrix4f *worlds;
+    uint32_t *_parentSlots;
+    uint32_t *_depths;
+    TransformId *_ids;
+    uint32_t *_slots;
+    bool *_isLocalUpdateNeeded;
+    bool *_isWorldChanged;
+    bool _isUpdateNeeded;
+    bool _hasChangedWorlds;
+} TransformTree;
+
+TransformTree *tr_allocate(size_t capacity);
+
+void tr_dispose(TransformTree *t);
+
+/**
+ * Adds a node with an identity local transform under parent, or as a root with TR_NO_PARENT.
+ */
+TransformId tr_add(TransformTree *t, TransformId parent);
+
+void tr_setPosition(TransformTree *t, TransformId id, const Vector3f *position);
+
+void tr_setOrientation(TransformTree *t, TransformId id, const Quatf *orientation);
+
+void tr_setScale(TransformTree *t, TransformId id, const Vector3f *scale);
+
+/**
+ * Recomputes the local matrices that were changed and the world matrices of their subtrees. Does no matrix
+ * work when nothing changed since the last call. Returns the number of world matrices recomputed.
+ */
+size_t tr_update(TransformTree *t);
+
+const Matrix4f *tr_getWorld(const TransformTree *t, TransformId id);
+
+/**
+ * Whether the world matrix of the node was recomputed by the last tr_update.
+ */
+bool tr_isWorldChanged(const TransformTree *t, TransformId id);
+
+#endif //TRANSFORM_H
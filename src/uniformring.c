@@ -0,0 +1,108 @@
+#include "uniformring.h"
+
+#include <stdlib.h>
+
+#include "glstate.h"
+
+// How long a wait for a fence may block before it is counted and retried
+#define FENCE_WAIT_NS 1000000
+
+static size_t getAlignment() {
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment > 0 ? (size_t) alignment : 1;
+}
+
+size_t ring_getBlockSpace(const size_t size) {
+    const size_t alignment = getAlignment();
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+UniformRing *ring_allocate(const size_t regionSize, const unsigned regionCount) {
+    UniformRing *r = calloc(1, sizeof(UniformRing));
+    r->alignment = getAlignment();
+    // Regions start aligned, so the offsets of their blocks only need aligning within them
+    r->regionSize = (regionSize + r->alignment - 1) / r->alignment * r->alignment;
+    r->regionCount = regionCount;
+    r->region = 0;
+    r->fences = calloc(regionCount, sizeof(GLsync));
+    r->isPersistent = GLAD_GL_VERSION_4_4;
+
+    const GLsizeiptr size = (GLsizeiptr) (r->regionSize * regionCount);
+    glGenBuffers(1, &r->buffer);
+    gls_bindBuffer(GL_UNIFORM_BUFFER, r->buffer);
+    if (r->isPersistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+        r->memory = glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+        r->memory = malloc(size);
+    }
+    return r;
+}
+
+void ring_dispose(UniformRing *r) {
+    for (unsigned i = 0; i < r->regionCount; i++) {
+        if (r->fences[i] != NULL) glDeleteSync(r->fences[i]);
+    }
+    if (r->isPersistent) {
+        gls_bindBuffer(GL_UNIFORM_BUFFER, r->buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else {
+        free(r->memory);
+    }
+    gls_deleteBuffers(1, &r->buffer);
+    free(r->fences);
+    free(r);
+}
+
+void ring_beginFrame(UniformRing *const r) {
+    r->region = (r->region + 1) % r->regionCount;
+    r->offset = 0;
+    r->_uploaded = 0;
+
+    GLsync *const fence = r->fences + r->region;
+    if (*fence == NULL) return;
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    GLenum status = glClientWaitSync(*fence, flags, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        r->stalls++;
+        // The flush was already requested, later waits only need to block
+        flags = 0;
+        do {
+            status = glClientWaitSync(*fence, flags, FENCE_WAIT_NS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(*fence);
+    *fence = NULL;
+}
+
+void ring_endFrame(UniformRing *const r) {
+    if (!r->isPersistent) return;
+    r->fences[r->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+RingBlock ring_allocateBlock(UniformRing *const r, const size_t size) {
+    const size_t offset = (r->offset + r->alignment - 1) / r->alignment * r->alignment;
+    if (offset + size > r->regionSize) return (RingBlock) {NULL, 0, 0};
+    r->offset = offset + size;
+
+    const size_t bufferOffset = r->region * r->regionSize + offset;
+    return (RingBlock) {r->memory + bufferOffset, (GLintptr) bufferOffset, (GLsizeiptr) size};
+}
+
+void ring_bind(UniformRing *const r, const GLuint binding, const RingBlock *const block) {
+    if (!r->isPersistent) {
+        // Uploads everything written since the last bind in one call
+        const size_t regionStart = r->region * r->regionSize;
+        const size_t end = (size_t) block->offset + (size_t) block->size - regionStart;
+        if (end > r->_uploaded) {
+            gls_bindBuffer(GL_UNIFORM_BUFFER, r->buffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr) (regionStart + r->_uploaded),
+                            (GLsizeiptr) (end - r->_uploaded), r->memory + regionStart + r->_uploaded);
+            r->_uploaded = end;
+        }
+    }
+    gls_bindBufferRange(GL_UNIFORM_BUFFER, binding, r->buffer, block->offset, block->size);
+}
@@ -0,0 +1,68 @@
+#ifndef UNIFORMRING_H
+#define UNIFORMRING_H
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "glad/glad.h"
+
+/**
+ * Room in the ring for one uniform block, bound with ring_bind. data is NULL if the frame's region was full.
+ */
+typedef struct {
+    void *data;
+    GLintptr offset;
+    GLsizeiptr size;
+} RingBlock;
+
+/**
+ * A uniform buffer split into regionCount regions, one per frame in flight. Blocks are written straight into a
+ * buffer mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, and a fence per region keeps a frame from
+ * overwriting a region the GPU may still read. Without OpenGL 4.4 the blocks are written to memory and uploaded
+ * with glBufferSubData when they are bound.
+ */
+typedef struct {
+    GLuint buffer;
+    unsigned char *memory;
+    size_t regionSize;
+    unsigned regionCount, region;
+    size_t offset;
+    size_t alignment;
+    GLsync *fences;
+    bool isPersistent;
+    /**
+     * Times ring_beginFrame had to wait for the GPU since the ring was allocated.
+     */
+    size_t stalls;
+    size_t _uploaded;
+} UniformRing;
+
+/**
+ * The room a block of size bytes takes in a region, its size rounded up to the uniform buffer offset alignment.
+ */
+size_t ring_getBlockSpace(size_t size);
+
+UniformRing *ring_allocate(size_t regionSize, unsigned regionCount);
+
+void ring_dispose(UniformRing *r);
+
+/**
+ * Moves to the next region, waiting until the GPU has finished the frame that last used it.
+ */
+void ring_beginFrame(UniformRing *r);
+
+/**
+ * Fences the region of the frame, call it after the frame's last draw.
+ */
+void ring_endFrame(UniformRing *r);
+
+/**
+ * Takes room for a std140 block of size bytes from the frame's region.
+ */
+RingBlock ring_allocateBlock(UniformRing *r, size_t size);
+
+/**
+ * Binds a block written since it was allocated to a uniform block binding with glBindBufferRange.
+ */
+void ring_bind(UniformRing *r, GLuint binding, const RingBlock *block);
+
+#endif //UNIFORMRING_H
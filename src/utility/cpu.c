@@ -0,0 +1,17 @@
+#include "cpu.h"
+
+bool cpu_hasFeature(const CpuFeature feature) {
+#if defined(__x86_64__) || defined(__i386__)
+    // May be called from constructors, which can run before the compiler's own CPU detection
+    __builtin_cpu_init();
+    switch (feature) {
+        case CPU_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CPU_AVX:
+            return __builtin_cpu_supports("avx");
+        case CPU_FMA:
+            return __builtin_cpu_supports("avx") && __builtin_cpu_supports("fma");
+    }
+#endif
+    return false;
+}
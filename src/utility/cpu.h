@@ -0,0 +1,13 @@
+#ifndef CPU_H
+#define CPU_H
+#include <stdbool.h>
+
+typedef enum {
+    CPU_SSE2,
+    CPU_AVX,
+    CPU_FMA,
+} CpuFeature;
+
+bool cpu_hasFeature(CpuFeature feature);
+
+#endif //CPU_H
@@ -8,12 +8,26 @@
 
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
+#include "batch.h"
+#include "geometry.h"
+#include "glstate.h"
+#include "gpucull.h"
 #include "math/matrix.h"
-#include "math/rad.h"
+#include "mesh.h"
+#include "renderqueue.h"
+#include "shadervariants.h"
+#include "transform.h"
 #include "utility/log.h"
 
-const char *resourceDirectory = "";
-const char *shaderDirectory = "shaders/";
+// Distance from the center of the 2x2x2 cube to its corners, bounds it in any orientation
+#define CUBE_BOUNDING_RADIUS 1.7320508f
+#define STRESS_CUBE_COUNT 100000
+#define BATCH_OBJECT_COUNT 20000
+#define QUEUE_OBJECT_COUNT 10000
+// Frames the CPU may prepare while the GPU still draws earlier ones
+#define FRAMES_IN_FLIGHT 3
+// Feature bit of object.frag's variant that ignores the vertex colors
+#define OBJECT_FLAT 1
 
 __attribute__ ((format(printf, 2, 3)))
 static void llog(const char *const level, char *const format, ...) {
@@ -23,68 +37,196 @@ static void llog(const char *const level, char *const format, ...) {
     va_end(args);
 }
 
-static void checkShaderProgramLinking(WindowData *const win) {
-    GLint isLinked;
-    glGetProgramiv(win->_shaderProgram, GL_LINK_STATUS, &isLinked);
-    if (isLinked == GL_FALSE) {
-        int logLength;
-        glGetProgramiv(win->_shaderProgram, GL_INFO_LOG_LENGTH, &logLength);
-
-        char *log = malloc(logLength * sizeof(char));
-        glGetProgramInfoLog(win->_shaderProgram, logLength, NULL, log);
-
-        llog(ERROR, "Shader program failed to link: %s", log);
-        free(log);
-        win_disposeAndAbort(win);
+static const float pyramidPositions[] = {
+    -1.0f, -1.0f, -1.0f,
+    1.0f, -1.0f, -1.0f,
+    1.0f, -1.0f, 1.0f,
+    -1.0f, -1.0f, 1.0f,
+    0.0f, 1.0f, 0.0f,
+};
+static const float pyramidColors[] = {
+    0.583f, 0.771f, 0.014f,
+    0.609f, 0.115f, 0.436f,
+    0.327f, 0.483f, 0.844f,
+    0.822f, 0.569f, 0.201f,
+    0.997f, 0.513f, 0.064f,
+};
+static const uint32_t pyramidIndices[] = {0, 1, 2, 0, 2, 3, 0, 4, 1, 1, 4, 2, 2, 4, 3, 3, 4, 0};
+
+static const float octahedronPositions[] = {
+    1.0f, 0.0f, 0.0f,
+    -1.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f,
+    0.0f, -1.0f, 0.0f,
+    0.0f, 0.0f, 1.0f,
+    0.0f, 0.0f, -1.0f,
+};
+static const float octahedronColors[] = {
+    0.055f, 0.953f, 0.042f,
+    0.714f, 0.505f, 0.345f,
+    0.783f, 0.290f, 0.734f,
+    0.722f, 0.645f, 0.174f,
+    0.302f, 0.455f, 0.848f,
+    0.225f, 0.587f, 0.040f,
+};
+static const uint32_t octahedronIndices[] = {
+    2, 0, 4, 2, 4, 1, 2, 1, 5, 2, 5, 0,
+    3, 4, 0, 3, 1, 4, 3, 5, 1, 3, 0, 5,
+};
+
+/**
+ * Objects with static transforms, culled as a batch of bounding spheres and drawn either as instances of one mesh
+ * or through the multi-draw batch renderer.
+ */
+typedef struct {
+    size_t count;
+    TransformTree *transforms;
+    uint32_t *meshes;
+    Vector3f *colors;
+    float *x, *y, *z, *radius;
+    uint32_t *visible;
+    Matrix4f *visibleModels;
+    Vector3f *visibleColors;
+    MeshInstances *instances;
+    BatchRenderer *batch;
+} Scene;
+
+/**
+ * Lays count objects out, one at the origin or a grid of 100 x 100 columns around it, cycling through meshCount meshes.
+ */
+static Scene *createScene(const size_t count, const uint32_t meshCount) {
+    Scene *s = calloc(1, sizeof(Scene));
+    s->count = count;
+    s->transforms = tr_allocate(count);
+    s->meshes = malloc(count * sizeof(uint32_t));
+    s->colors = malloc(count * sizeof(Vector3f));
+    s->x = malloc(4 * count * sizeof(float));
+    s->y = s->x + count;
+    s->z = s->y + count;
+    s->radius = s->z + count;
+    s->visible = malloc(count * sizeof(uint32_t));
+    s->visibleModels = aligned_alloc(_Alignof(Matrix4f), count * sizeof(Matrix4f));
+    s->visibleColors = malloc(count * sizeof(Vector3f));
+
+    const size_t layers = count / 10000 > 0 ? count / 10000 : 1;
+    for (size_t i = 0; i < count; i++) {
+        const TransformId id = tr_add(s->transforms, TR_NO_PARENT);
+        s->meshes[i] = (uint32_t) (i % meshCount);
+        s->radius[i] = CUBE_BOUNDING_RADIUS;
+        if (count == 1) {
+            s->colors[i] = (Vector3f) {1.0f, 1.0f, 1.0f};
+            continue;
+        }
+        // A tint and a tilt that vary per object
+        const Vector3f position = {
+            (float) ((int) (i % 100) - 50) * 4.0f,
+            (float) ((int) (i / 100 % layers) - (int) layers / 2) * 4.0f,
+            (float) ((int) (i / (100 * layers)) - 50) * 4.0f,
+        };
+        const Vector3f rotation = {(float) (i % 7) * 0.4f, (float) (i % 11) * 0.3f, 0.0f};
+        Quatf orientation;
+        quat_fromEuler(&orientation, &rotation);
+        tr_setPosition(s->transforms, id, &position);
+        tr_setOrientation(s->transforms, id, &orientation);
+        s->colors[i] = (Vector3f) {
+            0.5f + (float) (i * 37 % 101) / 200.0f,
+            0.5f + (float) (i * 61 % 103) / 200.0f,
+            0.5f + (float) (i * 89 % 107) / 200.0f,
+        };
     }
+    return s;
 }
 
-static void checkShaderCompilation(WindowData *const win, const GLuint shader) {
-    GLint isCompiled;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
-    if (isCompiled == GL_FALSE) {
-        int logLength;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-
-        char *log = malloc(logLength * sizeof(char));
-        glGetShaderInfoLog(shader, logLength, NULL, log);
+static void disposeScene(Scene *s) {
+    tr_dispose(s->transforms);
+    free(s->meshes);
+    free(s->colors);
+    free(s->x);
+    free(s->visible);
+    free(s->visibleModels);
+    free(s->visibleColors);
+    if (s->instances != NULL) mesh_disposeInstances(s->instances);
+    if (s->batch != NULL) batch_dispose(s->batch);
+    free(s);
+}
 
-        llog(ERROR, "Compilation failed: %s", log);
-        free(log);
-        win_disposeAndAbort(win);
+/**
+ * Culls the scene against the camera and returns the number of visible objects, listed in scene->visible.
+ */
+static size_t cullScene(const WindowData *const win, Scene *const scene) {
+    camblock_update(win->cameraBlock, win->camera);
+    // Does no matrix work while the objects stay where they are
+    if (tr_update(scene->transforms) > 0) {
+        for (size_t i = 0; i < scene->count; i++) {
+            const Matrix4f *const world = tr_getWorld(scene->transforms, (TransformId) i);
+            scene->x[i] = world->t[3][0];
+            scene->y[i] = world->t[3][1];
+            scene->z[i] = world->t[3][2];
+        }
     }
+    return cull_spheres(win->camera->frustum, scene->x, scene->y, scene->z, scene->radius, scene->count,
+                        scene->visible);
 }
 
-static void render(const WindowData *const win, const GLint mvpUniform, const GLuint vertexBuffer, const GLuint vertexColorBuffer) {
+static void renderInstances(const WindowData *const win, Scene *const scene, const GLuint program) {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(win->_shaderProgram);
-
-    cam_updateMatrices(win->camera);
-    Matrix4f mvp = {};
-    Matrix4f m = {};
-    Matrix4f p = {};
-    Matrix4f r = {};
-    const Vector3f pos = {0.0f, 0.0f, 0.0f};
-    const Vector3f rot = {toRad(0.0f), toRad(0.0f), toRad(0.0f)};
-    mat_translation(&p, &pos);
-    mat_rotation(&r, &rot);
-    mat_multMat4f(&p, &r, &m);
-    mat_multMat4f(win->camera->vp, &m, &mvp);
-
-    glUniformMatrix4fv(mvpUniform, 1, GL_FALSE, mvp.t[0]);
+    gls_useProgram(program);
 
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    const size_t visibleCount = cullScene(win, scene);
+    for (size_t i = 0; i < visibleCount; i++) {
+        const TransformId id = scene->visible[i];
+        scene->visibleModels[i] = *tr_getWorld(scene->transforms, id);
+        scene->visibleColors[i] = scene->colors[id];
+    }
+    mesh_setInstances(scene->instances, scene->visibleModels, scene->visibleColors, visibleCount);
+    mesh_drawInstances(scene->instances);
+}
 
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexColorBuffer);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
+static void renderBatch(const WindowData *const win, Scene *const scene, const GLuint program) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    gls_useProgram(program);
+
+    const size_t visibleCount = cullScene(win, scene);
+    batch_begin(scene->batch);
+    for (size_t i = 0; i < visibleCount; i++) {
+        const TransformId id = scene->visible[i];
+        const Vector3f *const color = scene->colors + id;
+        const Vector4f tint = {color->x, color->y, color->z, 1.0f};
+        batch_draw(scene->batch, scene->meshes[id], tr_getWorld(scene->transforms, id), &tint);
+    }
+    batch_submit(scene->batch);
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 12 * 3);
+/**
+ * Welds a triangle soup by position, each corner keeping the color it has first, and optimizes the triangle and
+ * vertex order. vertices needs room for count interleaved vertices and indices for count indices; returns the number
+ * of vertices left.
+ */
+static size_t buildIndexedMesh(const float positions[], const float colors[], const size_t count, float vertices[],
+                               uint32_t indices[]) {
+    const size_t vertexFloats = mesh_getVertexFloats(MESH_POSITION | MESH_COLOR);
+    float weldedPositions[3 * count];
+    const size_t vertexCount = geo_weld(positions, count, 3, weldedPositions, indices);
+
+    float weldedColors[3 * vertexCount];
+    bool isColored[vertexCount];
+    memset(isColored, 0, sizeof(isColored));
+    for (size_t i = 0; i < count; i++) {
+        if (isColored[indices[i]]) continue;
+        memcpy(weldedColors + 3 * indices[i], colors + 3 * i, 3 * sizeof(float));
+        isColored[indices[i]] = true;
+    }
+    mesh_interleave(MESH_POSITION | MESH_COLOR, weldedPositions, weldedColors, NULL, NULL, vertexCount, vertices);
 
+    GeoCacheStats stats = geo_analyzeVertexCache(indices, count, vertexCount, GEO_CACHE_SIZE);
+    llog(INFO, "Welded %zu vertices into %zu, ACMR %.3f, ATVR %.3f", count, vertexCount, stats.acmr, stats.atvr);
+    geo_optimizeVertexCache(indices, count, vertexCount, GEO_CACHE_SIZE);
+    geo_optimizeOverdraw(indices, count, vertices, vertexCount, vertexFloats, GEO_CACHE_SIZE);
+    const size_t usedCount = geo_optimizeVertexFetch(vertices, vertexCount, vertexFloats, indices, count);
+    stats = geo_analyzeVertexCache(indices, count, usedCount, GEO_CACHE_SIZE);
+    llog(INFO, "Optimized the mesh, ACMR %.3f, ATVR %.3f", stats.acmr, stats.atvr);
 
-    glDisableVertexAttribArray(0);
+    return usedCount;
 }
 
 WindowData *win_init(const int width, const int height, const char *title) {
@@ -100,8 +242,12 @@ WindowData *win_init(const int width, const int height, const char *title) {
     win->width = width;
     win->height = height;
     win->camera = cam_allocate();
-    win->camera->aspect = (float) height / (float) width;
+    cam_setAspect(win->camera, (float) height / (float) width);
+    win->cameraBlock = NULL;
+    win->shaderWatcher = NULL;
+    win->_shaderProgram = NULL;
     win->envDisposer = NULL;
+    win->scene = WIN_SCENE_CUBE;
     if (NULL == win->id) {
         llog(ERROR, "Failed to create GLFW window");
         glfwTerminate();
@@ -113,52 +259,283 @@ WindowData *win_init(const int width, const int height, const char *title) {
     glfwMakeContextCurrent(win->id);
     gladLoadGL();
     glfwGetFramebufferSize(win->id, &viewportWidth, &viewportHeight);
-    glViewport(0, 0, viewportWidth, viewportHeight);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    // Nothing is known about a new context, every first call goes through
+    gls_invalidate();
+    gls_viewport(0, 0, viewportWidth, viewportHeight);
+    gls_setDepthTest(true);
+    gls_depthFunc(GL_LESS);
+    glClearColor(0.302f, 0.286f, 0.631f, 1.0f);
+    shader_initParallelCompile();
+    win->cameraBlock = camblock_allocate();
+    camblock_setViewport(win->cameraBlock, (float) viewportWidth, (float) viewportHeight);
+    win->shaderWatcher = swatch_allocate();
     glfwSwapInterval(1);
     return win;
 }
 
+static void showLoadingFrame(const WindowData *const win) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glfwSwapBuffers(win->id);
+    glfwPollEvents();
+}
+
+/**
+ * Shows empty loading frames until every job is done, then writes their programs to res in the same order. Returns
+ * false if any of them failed, in which case none of the programs are kept.
+ */
+static bool waitForPrograms(const WindowData *const win, ShaderJob *jobs[], const size_t count, GLuint res[]) {
+    size_t loadingFrames = 0;
+    while (true) {
+        bool isFinished = true;
+        for (size_t i = 0; i < count; i++) isFinished = shader_pollJob(jobs[i]) && isFinished;
+        if (isFinished) break;
+        showLoadingFrame(win);
+        loadingFrames++;
+    }
+
+    bool isLinked = true;
+    for (size_t i = 0; i < count; i++) {
+        res[i] = shader_finishJob(jobs[i]);
+        isLinked = isLinked && res[i] != 0;
+    }
+    if (!isLinked) {
+        for (size_t i = 0; i < count; i++) glDeleteProgram(res[i]);
+        return false;
+    }
+    llog(INFO, "%zu programs ready after %zu loading frames", count, loadingFrames);
+    return true;
+}
+
 void win_compileShaders(WindowData *const win, const Shader shaders[], const size_t count) {
-    GLuint shaderIds[count];
+    ShaderJob *job = shader_submitProgram(shaders, count);
+    GLuint program;
+    if (!waitForPrograms(win, &job, 1, &program)) win_disposeAndAbort(win);
+    const char *filenames[count];
+    for (size_t i = 0; i < count; i++) filenames[i] = shaders[i].filename;
+    win->_shaderProgram = swatch_add(win->shaderWatcher, program, filenames, count);
+}
+
+typedef struct {
+    double time;
+    unsigned frames;
+} FrameReport;
+
+/**
+ * Counts a frame and returns true every 5 seconds, with the average frame time since the last report in msPerFrame.
+ * Also reports and restarts the state cache's counts, which therefore cover the frame that just ended.
+ */
+static bool isReportDue(FrameReport *const report, double *const msPerFrame) {
+    const GlStateStats stateStats = gls_stats;
+    gls_resetStats();
+    report->frames++;
+    const double time = glfwGetTime();
+    if (time - report->time < 5.0) return false;
+    *msPerFrame = (time - report->time) * 1000.0 / report->frames;
+    report->time = time;
+    report->frames = 0;
+    llog(INFO, "%zu of %zu GL state calls skipped in the last frame", stateStats.skipped, stateStats.calls);
+    return true;
+}
+
+static void interleaveShapes(float pyramid[], float octahedron[]) {
+    mesh_interleave(MESH_POSITION | MESH_COLOR, pyramidPositions, pyramidColors, NULL, NULL, 5, pyramid);
+    mesh_interleave(MESH_POSITION | MESH_COLOR, octahedronPositions, octahedronColors, NULL, NULL, 6, octahedron);
+}
 
-    for (int i = 0; i < count; i++) {
-        Shader const shader = shaders[i];
-        const GLuint shaderId = glCreateShader(shader.type);
-        shaderIds[i] = shaderId;
+/**
+ * Packs the cube, the pyramid and the octahedron, in this order, into the megabuffers of a new batch renderer.
+ */
+static BatchRenderer *createSceneBatch(const size_t drawCapacity, const float cubeVertices[],
+                                       const size_t cubeVertexCount, const uint32_t cubeIndices[],
+                                       const size_t cubeIndexCount) {
+    const size_t vertexFloats = mesh_getVertexFloats(MESH_POSITION | MESH_COLOR);
+    float pyramid[5 * vertexFloats], octahedron[6 * vertexFloats];
+    interleaveShapes(pyramid, octahedron);
+
+    BatchRenderer *batch = batch_allocate(MESH_POSITION | MESH_COLOR, drawCapacity);
+    batch_addMesh(batch, cubeVertices, cubeVertexCount, cubeIndices, cubeIndexCount);
+    batch_addMesh(batch, pyramid, 5, pyramidIndices, sizeof(pyramidIndices) / sizeof(pyramidIndices[0]));
+    batch_addMesh(batch, octahedron, 6, octahedronIndices, sizeof(octahedronIndices) / sizeof(octahedronIndices[0]));
+    batch_build(batch);
+    return batch;
+}
 
-        llog(INFO, "Compiling (%s) shader", shader.filename);
-        glShaderSource(shaderId, 1, &shader.source, NULL);
-        glCompileShader(shaderId);
-        checkShaderCompilation(win, shaderId);
+/**
+ * Cubes, pyramids and octahedra in shared megabuffers, drawn with one multi-draw call that reads per-draw data from
+ * a shader storage buffer.
+ */
+static void renderBatchScene(WindowData *const win, const float cubeVertices[], const size_t cubeVertexCount,
+                             const uint32_t cubeIndices[], const size_t cubeIndexCount) {
+    if (!GLAD_GL_VERSION_4_6) {
+        llog(ERROR, "The batch scene needs OpenGL 4.6");
+        win_disposeAndAbort(win);
     }
+    const char *const shaderFilenames[] = {"batch.vert", "s.frag"};
+    ShaderJob *job = shader_submitFiles(shaderFilenames, 2);
+    GLuint program;
+    if (job == NULL || !waitForPrograms(win, &job, 1, &program)) win_disposeAndAbort(win);
 
-    llog(INFO, "Creating a shader program");
-    win->_shaderProgram = glCreateProgram();
-    llog(INFO, "Attaching the shaders to the program");
-    for (int i = 0; i < count; i++) {
-        glAttachShader(win->_shaderProgram, shaderIds[i]);
+    Scene *scene = createScene(BATCH_OBJECT_COUNT, 3);
+    scene->batch = createSceneBatch(scene->count, cubeVertices, cubeVertexCount, cubeIndices, cubeIndexCount);
+    llog(INFO, "Drawing %zu objects of 3 meshes with one multi-draw call per frame", scene->count);
+
+    const WatchedProgram *watched = swatch_add(win->shaderWatcher, program, shaderFilenames, 2);
+    FrameReport report = {glfwGetTime(), 0};
+    while (!glfwWindowShouldClose(win->id)) {
+        swatch_update(win->shaderWatcher);
+        renderBatch(win, scene, watched->program);
+        glfwSwapBuffers(win->id);
+        glfwPollEvents();
+        double msPerFrame;
+        if (isReportDue(&report, &msPerFrame)) {
+            llog(INFO, "%.2f ms per frame, %zu objects visible", msPerFrame, scene->batch->drawCount);
+        }
     }
-    llog(INFO, "Linking the shader program");
-    glLinkProgram(win->_shaderProgram);
-    checkShaderProgramLinking(win);
-
-    for (int i = 0; i < count; i++) {
-        const Shader shader = shaders[i];
-        const GLuint shaderId = shaderIds[i];
-        llog(INFO, "Detaching the (%s) shader from the program", shader.filename);
-        glDetachShader(win->_shaderProgram, shaderId);
-        llog(INFO, "Deleting the (%s) shader", shader.filename);
-        glDeleteShader(shaderId);
+    disposeScene(scene);
+}
+
+/**
+ * The batch scene's meshes for 100k objects, culled and turned into draw commands on the GPU.
+ */
+static void renderGpuCullScene(WindowData *const win, const float cubeVertices[], const size_t cubeVertexCount,
+                               const uint32_t cubeIndices[], const size_t cubeIndexCount) {
+    if (!GLAD_GL_VERSION_4_6) {
+        llog(ERROR, "The GPU culling scene needs OpenGL 4.6");
+        win_disposeAndAbort(win);
+    }
+    const char *const shaderFilenames[] = {"culled.vert", "s.frag"};
+    ShaderJob *job = shader_submitFiles(shaderFilenames, 2);
+    if (job == NULL) win_disposeAndAbort(win);
+    // The compute program is loaded while the driver works on the other one
+    ComputeProgram *cullProgram = comp_load("cull.comp");
+    GLuint program;
+    if (!waitForPrograms(win, &job, 1, &program) || cullProgram == NULL) win_disposeAndAbort(win);
+
+    Scene *scene = createScene(STRESS_CUBE_COUNT, 3);
+    scene->batch = createSceneBatch(0, cubeVertices, cubeVertexCount, cubeIndices, cubeIndexCount);
+    GpuCull *cull = gpucull_allocate(scene->batch, cullProgram, scene->count);
+
+    // The objects never move, so they are uploaded once
+    tr_update(scene->transforms);
+    GpuCullObject *objects = malloc(scene->count * sizeof(GpuCullObject));
+    for (size_t i = 0; i < scene->count; i++) {
+        const Matrix4f *const world = tr_getWorld(scene->transforms, (TransformId) i);
+        const Vector3f *const color = scene->colors + i;
+        memcpy(objects[i].model, world->t, sizeof(world->t));
+        objects[i].sphere = (Vector4f) {world->t[3][0], world->t[3][1], world->t[3][2], scene->radius[i]};
+        objects[i].color = (Vector4f) {color->x, color->y, color->z, 1.0f};
+        objects[i].mesh = scene->meshes[i];
+    }
+    gpucull_setObjects(cull, objects, 0, scene->count);
+    free(objects);
+    llog(INFO, "Culling %zu objects of 3 meshes on the GPU", scene->count);
+
+    const WatchedProgram *watched = swatch_add(win->shaderWatcher, program, shaderFilenames, 2);
+    const WatchedProgram *watchedCull = swatch_addCompute(win->shaderWatcher, cullProgram, "cull.comp");
+    FrameReport report = {glfwGetTime(), 0};
+    while (!glfwWindowShouldClose(win->id)) {
+        swatch_update(win->shaderWatcher);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        camblock_update(win->cameraBlock, win->camera);
+        gpucull_cull(cull, win->camera);
+        gls_useProgram(watched->program);
+        gpucull_draw(cull);
+        glfwSwapBuffers(win->id);
+        glfwPollEvents();
+        double msPerFrame;
+        if (isReportDue(&report, &msPerFrame)) {
+            llog(INFO, "%.2f ms per frame, %u objects visible", msPerFrame, gpucull_readVisibleCount(cull));
+        }
     }
+    swatch_remove(win->shaderWatcher, watchedCull);
+    gpucull_dispose(cull);
+    disposeScene(scene);
 }
 
-void win_startRenderCycle(const WindowData *const win) {
-    GLuint vertexArray;
-    glGenVertexArrays(1, &vertexArray);
-    glBindVertexArray(vertexArray);
+/**
+ * The batch scene's meshes as separate vertex arrays, drawn one by one through the render queue with two programs
+ * and a translucent material.
+ */
+static void renderQueueScene(WindowData *const win, const float cubeVertices[], const size_t cubeVertexCount,
+                             const uint32_t cubeIndices[], const size_t cubeIndexCount) {
+    const char *const shaderFilenames[] = {"object.vert", "object.frag"};
+    const char *const features[] = {"FLAT"};
+    ShaderVariants *variants = svar_allocate(shaderFilenames, 2, features, 1);
+    if (variants == NULL) win_disposeAndAbort(win);
+    svar_prepare(variants, 0);
+    svar_prepare(variants, OBJECT_FLAT);
+    size_t loadingFrames = 0;
+    for (; !svar_poll(variants); loadingFrames++) showLoadingFrame(win);
+    GLuint programs[] = {svar_get(variants, 0), svar_get(variants, OBJECT_FLAT)};
+    if (programs[0] == 0 || programs[1] == 0) win_disposeAndAbort(win);
+    llog(INFO, "Variants ready after %zu loading frames", loadingFrames);
+    const WatchedProgram *watched = swatch_addVariants(win->shaderWatcher, variants);
+    size_t reloads = variants->reloads;
+
+    const size_t vertexFloats = mesh_getVertexFloats(MESH_POSITION | MESH_COLOR);
+    float pyramid[5 * vertexFloats], octahedron[6 * vertexFloats];
+    interleaveShapes(pyramid, octahedron);
+    Mesh *meshes[] = {
+        mesh_uploadIndexed(MESH_POSITION | MESH_COLOR, cubeVertices, cubeVertexCount, cubeIndices, cubeIndexCount),
+        mesh_uploadIndexed(MESH_POSITION | MESH_COLOR, pyramid, 5, pyramidIndices,
+                           sizeof(pyramidIndices) / sizeof(pyramidIndices[0])),
+        mesh_uploadIndexed(MESH_POSITION | MESH_COLOR, octahedron, 6, octahedronIndices,
+                           sizeof(octahedronIndices) / sizeof(octahedronIndices[0])),
+    };
+    const RenderMaterial materials[] = {
+        {{1.0f, 1.0f, 1.0f, 1.0f}, RQ_LAYER_OPAQUE},
+        {{1.0f, 0.6f, 0.6f, 1.0f}, RQ_LAYER_OPAQUE},
+        {{0.6f, 0.8f, 1.0f, 1.0f}, RQ_LAYER_OPAQUE},
+        {{1.0f, 1.0f, 1.0f, 0.4f}, RQ_LAYER_TRANSPARENT},
+    };
+
+    Scene *scene = createScene(QUEUE_OBJECT_COUNT, 3);
+    UniformRing *ring = ring_allocate(scene->count * ring_getBlockSpace(sizeof(Matrix4f)), FRAMES_IN_FLIGHT);
+    RenderQueue *queue = rq_allocate(scene->count, materials, sizeof(materials) / sizeof(materials[0]), ring);
+    llog(INFO, "Drawing %zu objects through the render queue", scene->count);
+
+    FrameReport report = {glfwGetTime(), 0};
+    while (!glfwWindowShouldClose(win->id)) {
+        swatch_update(win->shaderWatcher);
+        if (variants->reloads != reloads) {
+            reloads = variants->reloads;
+            programs[0] = svar_get(variants, 0);
+            programs[1] = svar_get(variants, OBJECT_FLAT);
+            // The old programs are deleted and their names may already belong to new ones
+            rq_forgetPrograms(queue);
+        }
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        const size_t visibleCount = cullScene(win, scene);
+        rq_begin(queue, win->camera);
+        for (size_t i = 0; i < visibleCount; i++) {
+            const TransformId id = scene->visible[i];
+            // Programs and materials vary independently of the meshes
+            rq_submit(queue, meshes[scene->meshes[id]], programs[id % 5 == 0], id * 7 % 4,
+                      tr_getWorld(scene->transforms, id));
+        }
+        rq_sort(queue);
+        ring_beginFrame(ring);
+        rq_execute(queue);
+        ring_endFrame(ring);
+        glfwSwapBuffers(win->id);
+        glfwPollEvents();
+        double msPerFrame;
+        if (isReportDue(&report, &msPerFrame)) {
+            const RenderQueueStats *const stats = &queue->stats;
+            llog(INFO, "%.2f ms per frame, %zu draws with %zu program, %zu material and %zu vertex array changes",
+                 msPerFrame, stats->draws, stats->programChanges, stats->materialChanges, stats->vertexArrayChanges);
+            llog(INFO, "%zu waits for the GPU before reusing uniform ring regions so far", ring->stalls);
+        }
+    }
+    rq_dispose(queue);
+    ring_dispose(ring);
+    disposeScene(scene);
+    for (size_t i = 0; i < sizeof(meshes) / sizeof(meshes[0]); i++) mesh_dispose(meshes[i]);
+    swatch_remove(win->shaderWatcher, watched);
+    svar_dispose(variants);
+}
 
+void win_startRenderCycle(WindowData *const win) {
     const GLfloat vertices[] = {
         -1.0f, -1.0f, -1.0f,
         -1.0f, -1.0f, 1.0f,
@@ -236,25 +613,43 @@ void win_startRenderCycle(const WindowData *const win) {
         0.982f,  0.099f,  0.879f
     };
 
-    GLuint vertexBuffer;
-    glGenBuffers(1, &vertexBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    const size_t soupCount = sizeof(vertices) / sizeof(vertices[0]) / 3;
+    float cubeVertices[soupCount * mesh_getVertexFloats(MESH_POSITION | MESH_COLOR)];
+    uint32_t cubeIndices[soupCount];
+    const size_t cubeVertexCount = buildIndexedMesh(vertices, vertexColors, soupCount, cubeVertices, cubeIndices);
 
-    GLuint vertexColorBuffer;
-    glGenBuffers(1, &vertexColorBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexColorBuffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertexColors), vertexColors, GL_STATIC_DRAW);
-
-    glClearColor(0.302f, 0.286f, 0.631f, 1.0f);
+    if (win->scene == WIN_SCENE_BATCH) {
+        renderBatchScene(win, cubeVertices, cubeVertexCount, cubeIndices, soupCount);
+        return;
+    }
+    if (win->scene == WIN_SCENE_QUEUE) {
+        renderQueueScene(win, cubeVertices, cubeVertexCount, cubeIndices, soupCount);
+        return;
+    }
+    if (win->scene == WIN_SCENE_GPU_CULL) {
+        renderGpuCullScene(win, cubeVertices, cubeVertexCount, cubeIndices, soupCount);
+        return;
+    }
 
-    const GLint mvpUniform = glGetUniformLocation(win->_shaderProgram, "mvp");
+    Mesh *cube = mesh_uploadIndexed(MESH_POSITION | MESH_COLOR, cubeVertices, cubeVertexCount, cubeIndices,
+                                    soupCount);
+    Scene *scene = createScene(win->scene == WIN_SCENE_STRESS ? STRESS_CUBE_COUNT : 1, 1);
+    scene->instances = mesh_createInstances(cube, scene->count);
+    llog(INFO, "Drawing %zu cubes with one instanced call per frame", scene->count);
 
+    FrameReport report = {glfwGetTime(), 0};
     while (!glfwWindowShouldClose(win->id)) {
-        render(win, mvpUniform, vertexBuffer, vertexColorBuffer);
+        swatch_update(win->shaderWatcher);
+        renderInstances(win, scene, win->_shaderProgram->program);
         glfwSwapBuffers(win->id);
         glfwPollEvents();
+        double msPerFrame;
+        if (isReportDue(&report, &msPerFrame)) {
+            llog(INFO, "%.2f ms per frame, %zu cubes visible", msPerFrame, scene->instances->count);
+        }
     }
+    disposeScene(scene);
+    mesh_dispose(cube);
 }
 
 void win_disposeAndAbort(WindowData *const win) {
@@ -265,6 +660,8 @@ void win_disposeAndAbort(WindowData *const win) {
 
 void win_dispose(WindowData *const win) {
     if (win->envDisposer != NULL) win->envDisposer();
+    if (win->cameraBlock != NULL) camblock_dispose(win->cameraBlock);
+    if (win->shaderWatcher != NULL) swatch_dispose(win->shaderWatcher);
     glfwDestroyWindow(win->id);
     cam_dispose(win->camera);
     free(win);
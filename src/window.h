@@ -2,32 +2,57 @@
 #define WINDOW_H
 #define GLFW_INCLUDE_NONE
 #include "camera.h"
+#include "camerablock.h"
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
+#include "shader.h"
+#include "shaderwatch.h"
+
+typedef enum {
+    WIN_SCENE_CUBE,
+    /**
+     * 100k instanced cubes, most of them out of view.
+     */
+    WIN_SCENE_STRESS,
+    /**
+     * 20k objects of three different meshes drawn with multi-draw indirect, needs OpenGL 4.6.
+     */
+    WIN_SCENE_BATCH,
+    /**
+     * The batch scene's meshes for 100k objects, culled by a compute shader that writes the draw commands, needs
+     * OpenGL 4.6.
+     */
+    WIN_SCENE_GPU_CULL,
+    /**
+     * 10k objects of three meshes, two programs and four materials, one of them translucent, sorted and drawn one
+     * by one by the render queue.
+     */
+    WIN_SCENE_QUEUE,
+} WinScene;
 
 typedef struct {
     GLFWwindow *id;
-    GLuint _shaderProgram;
+    const WatchedProgram *_shaderProgram;
     size_t width, height;
     Camera *camera;
+    /**
+     * Shared by all programs, updated once per frame by the render loop.
+     */
+    CameraBlock *cameraBlock;
+    /**
+     * Rebuilds the scenes' programs when their files change, updated once per frame by the render loop.
+     */
+    ShaderWatcher *shaderWatcher;
+    WinScene scene;
 
     void (*envDisposer)(void);
 } WindowData;
 
-typedef struct {
-    const char *filename;
-    const GLchar *source;
-    GLenum type;
-} Shader;
-
-extern const char *resourceDirectory;
-extern const char *shaderDirectory;
-
 WindowData *win_init(int width, int height, const char *title);
 
 void win_compileShaders(WindowData *win, const Shader shaders[], size_t count);
 
-void win_startRenderCycle(const WindowData *win);
+void win_startRenderCycle(WindowData *win);
 
 void win_disposeAndAbort(WindowData *win);
 
@@ -0,0 +1,367 @@
+// Always calls the dispatched functions, even when the library is built with DUMMY3D_INLINE_MATH
+#define MATH_OUT_OF_LINE
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "math/matrix.h"
+#include "math/quaternion.h"
+
+/*
+ * Runs every matrix.h function on each backend the CPU supports and compares the results with the scalar backend.
+ * Counts that fill no whole register and results written over their inputs are covered too.
+ * Usage: dummy3d_math_conformance
+ * Exits with 1 and lists the mismatches if any backend disagrees with the scalar one.
+ */
+
+/**
+ * Largest difference allowed, absolute for values up to 1 and relative above. Products and builders only differ
+ * by the rounding of fused or reordered additions; inverses also divide by the determinant, which amplifies that.
+ */
+#define PRODUCT_TOLERANCE 1e-5f
+#define INVERSE_TOLERANCE 1e-4f
+
+#define MAX_COUNT 37
+#define MAX_VALUES 16384
+#define MAX_REPORTED 10
+
+// Odd counts, counts of one register and one more, so every tail path runs
+static const size_t counts[] = {1, 3, 4, 5, 7, 8, 9, 16, 17, MAX_COUNT};
+static const unsigned vectorFlags[] = {
+    MAT_TRANSFORM_POINT,
+    MAT_TRANSFORM_DIRECTION,
+    MAT_TRANSFORM_DIVIDE,
+    MAT_TRANSFORM_DIRECTION | MAT_TRANSFORM_DIVIDE,
+};
+
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+/**
+ * Everything a check produced on one backend, flattened to floats; returned bools become 0 or 1.
+ */
+typedef struct {
+    float values[MAX_VALUES];
+    size_t count;
+} Output;
+
+typedef struct {
+    const char *name;
+    float tolerance;
+    void (*run)(Output *out);
+} Check;
+
+static Matrix4f transforms[MAX_COUNT], rigids[MAX_COUNT], projections[MAX_COUNT], singulars[MAX_COUNT];
+// Perspective matrices of a camera at the origin, which sees every generated point with w between 1 and 10
+static Matrix4f cameras[MAX_COUNT];
+static Vector4f vectors4[MAX_COUNT];
+static Vector3f vectors3[MAX_COUNT], rotations[MAX_COUNT];
+static float xs[MAX_COUNT], ys[MAX_COUNT], zs[MAX_COUNT];
+static Quatf quats[MAX_COUNT];
+
+static uint32_t randomState = 0x9E3779B9u;
+
+static float randomRange(const float min, const float max) {
+    // xorshift32, the same inputs on every run and platform
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return min + (max - min) * (float) (randomState >> 8) / (float) (1u << 24);
+}
+
+static void put(Output *const out, const float value) {
+    if (out->count == MAX_VALUES) {
+        fprintf(stderr, "A check produced more than %d values\n", MAX_VALUES);
+        exit(2);
+    }
+    out->values[out->count++] = value;
+}
+
+static void putMatrices(Output *const out, const Matrix4f matrices[], const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) put(out, matrices[i].t[c][r]);
+        }
+    }
+}
+
+static void putFloats(Output *const out, const float values[], const size_t count) {
+    for (size_t i = 0; i < count; i++) put(out, values[i]);
+}
+
+/**
+ * Fills a matrix with a value no kernel produces, so entries a function must leave untouched are checked as well.
+ */
+static void poison(Matrix4f matrices[], const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) matrices[i].t[c][r] = -12345.0f;
+        }
+    }
+}
+
+static void generateInputs() {
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        const Vector3f rotation = {randomRange(-3.0f, 3.0f), randomRange(-3.0f, 3.0f), randomRange(-3.0f, 3.0f)};
+        const Vector3f position = {randomRange(-20.0f, 20.0f), randomRange(-20.0f, 20.0f), randomRange(-20.0f, 20.0f)};
+        Matrix4f translation, rotationMatrix, scale;
+        mat_setBackend(MAT_BACKEND_SCALAR);
+        mat_translation(&translation, &position);
+        mat_rotation(&rotationMatrix, &rotation);
+        mat_multMat4f(&translation, &rotationMatrix, rigids + i);
+
+        mat_identity(&scale);
+        scale.t[0][0] = randomRange(0.5f, 3.0f);
+        scale.t[1][1] = randomRange(0.5f, 3.0f);
+        scale.t[2][2] = randomRange(0.5f, 3.0f);
+        scale.t[1][0] = randomRange(-0.5f, 0.5f);
+        mat_multMat4f(rigids + i, &scale, transforms + i);
+
+        mat_perspective(cameras + i, randomRange(0.5f, 2.0f), randomRange(0.5f, 2.0f), 0.1f, 100.0f);
+        mat_multMat4f(cameras + i, rigids + i, projections + i);
+
+        // Every other matrix loses its last row and column so the singular cases show up between regular ones
+        singulars[i] = transforms[i];
+        if (i % 2 == 0) {
+            for (int c = 0; c < 4; c++) singulars[i].t[c][2] = 0.0f;
+        }
+
+        // Points in front of the cameras, so divides never come near w = 0
+        xs[i] = randomRange(-5.0f, 5.0f);
+        ys[i] = randomRange(-5.0f, 5.0f);
+        zs[i] = randomRange(-10.0f, -1.0f);
+        vectors3[i] = (Vector3f) {xs[i], ys[i], zs[i]};
+        vectors4[i] = (Vector4f) {xs[i], ys[i], zs[i], randomRange(0.5f, 2.0f)};
+        rotations[i] = rotation;
+        const Quatf quat = {randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f),
+                            randomRange(-1.0f, 1.0f)};
+        quat_normalize(&quat, quats + i);
+    }
+}
+
+static void runMultMat4f(Output *const out) {
+    for (size_t i = 0; i + 1 < MAX_COUNT; i++) {
+        Matrix4f res;
+        mat_multMat4f(transforms + i, projections + i + 1, &res);
+        putMatrices(out, &res, 1);
+    }
+}
+
+static void runMultMat4fAliased(Output *const out) {
+    for (size_t i = 0; i + 1 < MAX_COUNT; i++) {
+        Matrix4f left = transforms[i], right = projections[i + 1], square = rigids[i];
+        mat_multMat4f(&left, projections + i + 1, &left);
+        mat_multMat4f(transforms + i, &right, &right);
+        mat_multMat4f(&square, &square, &square);
+        putMatrices(out, &left, 1);
+        putMatrices(out, &right, 1);
+        putMatrices(out, &square, 1);
+    }
+}
+
+static void runMultVec4f(Output *const out) {
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        Vector4f res, aliased = vectors4[i];
+        mat_multVec4f(cameras + i, vectors4 + i, &res);
+        mat_multVec4f(transforms + i, &aliased, &aliased);
+        putFloats(out, &res.x, 4);
+        putFloats(out, &aliased.x, 4);
+    }
+}
+
+static void runMultVec4fArray(Output *const out) {
+    for (size_t f = 0; f < COUNT_OF(vectorFlags); f++) {
+        for (size_t c = 0; c < COUNT_OF(counts); c++) {
+            Vector4f res[MAX_COUNT], aliased[MAX_COUNT];
+            memcpy(aliased, vectors4, sizeof(vectors4));
+            mat_multVec4fArray(cameras + c, vectors4, res, counts[c], vectorFlags[f]);
+            mat_multVec4fArray(cameras + c, aliased, aliased, counts[c], vectorFlags[f]);
+            putFloats(out, &res[0].x, 4 * counts[c]);
+            putFloats(out, &aliased[0].x, 4 * counts[c]);
+        }
+    }
+}
+
+static void runMultVec3fArray(Output *const out) {
+    for (size_t f = 0; f < COUNT_OF(vectorFlags); f++) {
+        for (size_t c = 0; c < COUNT_OF(counts); c++) {
+            Vector3f res[MAX_COUNT], aliased[MAX_COUNT];
+            memcpy(aliased, vectors3, sizeof(vectors3));
+            mat_multVec3fArray(cameras + c, vectors3, res, counts[c], vectorFlags[f]);
+            mat_multVec3fArray(cameras + c, aliased, aliased, counts[c], vectorFlags[f]);
+            putFloats(out, &res[0].x, 3 * counts[c]);
+            putFloats(out, &aliased[0].x, 3 * counts[c]);
+        }
+    }
+}
+
+static void runMultVec3fSoA(Output *const out) {
+    for (size_t f = 0; f < COUNT_OF(vectorFlags); f++) {
+        for (size_t c = 0; c < COUNT_OF(counts); c++) {
+            const size_t count = counts[c];
+            float resX[MAX_COUNT], resY[MAX_COUNT], resZ[MAX_COUNT];
+            float x[MAX_COUNT], y[MAX_COUNT], z[MAX_COUNT];
+            memcpy(x, xs, sizeof(xs));
+            memcpy(y, ys, sizeof(ys));
+            memcpy(z, zs, sizeof(zs));
+            mat_multVec3fSoA(cameras + c, xs, ys, zs, resX, resY, resZ, count, vectorFlags[f]);
+            mat_multVec3fSoA(cameras + c, x, y, z, x, y, z, count, vectorFlags[f]);
+            putFloats(out, resX, count);
+            putFloats(out, resY, count);
+            putFloats(out, resZ, count);
+            putFloats(out, x, count);
+            putFloats(out, y, count);
+            putFloats(out, z, count);
+        }
+    }
+}
+
+static void runTranspose(Output *const out) {
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        Matrix4f res, aliased = projections[i];
+        mat_transpose(projections + i, &res);
+        mat_transpose(&aliased, &aliased);
+        putMatrices(out, &res, 1);
+        putMatrices(out, &aliased, 1);
+    }
+}
+
+static void runInverseRigid(Output *const out) {
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        Matrix4f res, aliased = rigids[i];
+        mat_inverseRigid(rigids + i, &res);
+        mat_inverseRigid(&aliased, &aliased);
+        putMatrices(out, &res, 1);
+        putMatrices(out, &aliased, 1);
+    }
+    for (size_t c = 0; c < COUNT_OF(counts); c++) {
+        Matrix4f res[MAX_COUNT], aliased[MAX_COUNT];
+        memcpy(aliased, rigids, sizeof(rigids));
+        mat_inverseRigidArray(rigids, res, counts[c]);
+        mat_inverseRigidArray(aliased, aliased, counts[c]);
+        putMatrices(out, res, counts[c]);
+        putMatrices(out, aliased, counts[c]);
+    }
+}
+
+/**
+ * Runs one of the inverse families on the regular and on the partly singular inputs, single and batched.
+ */
+static void runInverseFamily(Output *const out, const Matrix4f regulars[],
+                             bool (*const inverse)(const Matrix4f *, Matrix4f *),
+                             bool (*const inverseArray)(const Matrix4f *, Matrix4f *, size_t)) {
+    const Matrix4f *const inputs[] = {regulars, singulars};
+    for (size_t s = 0; s < COUNT_OF(inputs); s++) {
+        for (size_t i = 0; i < MAX_COUNT; i++) {
+            Matrix4f res, aliased = inputs[s][i];
+            poison(&res, 1);
+            put(out, (float) inverse(inputs[s] + i, &res));
+            put(out, (float) inverse(&aliased, &aliased));
+            putMatrices(out, &res, 1);
+            putMatrices(out, &aliased, 1);
+        }
+        for (size_t c = 0; c < COUNT_OF(counts); c++) {
+            Matrix4f res[MAX_COUNT], aliased[MAX_COUNT];
+            poison(res, MAX_COUNT);
+            memcpy(aliased, inputs[s], MAX_COUNT * sizeof(Matrix4f));
+            put(out, (float) inverseArray(inputs[s], res, counts[c]));
+            put(out, (float) inverseArray(aliased, aliased, counts[c]));
+            putMatrices(out, res, counts[c]);
+            putMatrices(out, aliased, counts[c]);
+        }
+    }
+}
+
+static void runInverseAffine(Output *const out) {
+    runInverseFamily(out, transforms, mat_inverseAffine, mat_inverseAffineArray);
+}
+
+static void runInverse(Output *const out) {
+    runInverseFamily(out, projections, mat_inverse, mat_inverseArray);
+}
+
+static void runBuilders(Output *const out) {
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        Matrix4f res[5];
+        poison(res, 5);
+        mat_identity(res);
+        mat_translation(res + 1, vectors3 + i);
+        mat_rotation(res + 2, rotations + i);
+        mat_rotationQuat(res + 3, quats + i);
+        mat_perspective(res + 4, 0.5f + (float) i / MAX_COUNT, 0.3f + (float) i / MAX_COUNT, 0.1f, 50.0f + (float) i);
+        putMatrices(out, res, 5);
+    }
+    for (size_t c = 0; c < COUNT_OF(counts); c++) {
+        Matrix4f res[MAX_COUNT];
+        poison(res, MAX_COUNT);
+        mat_rotationArray(res, rotations, counts[c]);
+        putMatrices(out, res, counts[c]);
+    }
+}
+
+static const Check checks[] = {
+    {"multMat4f", PRODUCT_TOLERANCE, runMultMat4f},
+    {"multMat4f aliased", PRODUCT_TOLERANCE, runMultMat4fAliased},
+    {"multVec4f", PRODUCT_TOLERANCE, runMultVec4f},
+    {"multVec4fArray", PRODUCT_TOLERANCE, runMultVec4fArray},
+    {"multVec3fArray", PRODUCT_TOLERANCE, runMultVec3fArray},
+    {"multVec3fSoA", PRODUCT_TOLERANCE, runMultVec3fSoA},
+    {"transpose", PRODUCT_TOLERANCE, runTranspose},
+    {"inverseRigid", PRODUCT_TOLERANCE, runInverseRigid},
+    {"inverseAffine", INVERSE_TOLERANCE, runInverseAffine},
+    {"inverse", INVERSE_TOLERANCE, runInverse},
+    {"identity, translation, rotation, rotationQuat, perspective", PRODUCT_TOLERANCE, runBuilders},
+};
+
+static bool isClose(const float expected, const float actual, const float tolerance) {
+    if (isnan(expected) || isnan(actual)) return isnan(expected) && isnan(actual);
+    return fabsf(expected - actual) <= tolerance * fmaxf(1.0f, fmaxf(fabsf(expected), fabsf(actual)));
+}
+
+int main() {
+    generateInputs();
+
+    static Output expected, actual;
+    size_t failures = 0, compared = 0;
+    for (MatBackend backend = MAT_BACKEND_SCALAR + 1; backend < MAT_BACKEND_COUNT; backend++) {
+        if (!mat_isBackendSupported(backend)) {
+            printf("%-6s skipped, not supported by this CPU\n", mat_getBackendName(backend));
+            continue;
+        }
+        size_t backendFailures = 0;
+        for (size_t c = 0; c < COUNT_OF(checks); c++) {
+            const Check *const check = checks + c;
+            expected.count = 0;
+            actual.count = 0;
+            mat_setBackend(MAT_BACKEND_SCALAR);
+            check->run(&expected);
+            mat_setBackend(backend);
+            check->run(&actual);
+
+            size_t mismatches = 0;
+            if (expected.count != actual.count) {
+                fprintf(stderr, "%s %s: %zu values instead of %zu\n", mat_getBackendName(backend), check->name,
+                        actual.count, expected.count);
+                mismatches++;
+            }
+            for (size_t i = 0; i < expected.count && i < actual.count; i++) {
+                if (isClose(expected.values[i], actual.values[i], check->tolerance)) continue;
+                if (mismatches < MAX_REPORTED) {
+                    fprintf(stderr, "%s %s: value %zu is %.9g instead of %.9g\n", mat_getBackendName(backend),
+                            check->name, i, actual.values[i], expected.values[i]);
+                }
+                mismatches++;
+            }
+            compared += expected.count;
+            backendFailures += mismatches;
+        }
+        printf("%-6s %s\n", mat_getBackendName(backend), backendFailures == 0 ? "matches scalar" : "MISMATCHES");
+        failures += backendFailures;
+    }
+    mat_setBackend(MAT_BACKEND_SCALAR);
+
+    printf("%zu values compared, %zu mismatches\n", compared, failures);
+    return failures == 0 ? 0 : 1;
+}